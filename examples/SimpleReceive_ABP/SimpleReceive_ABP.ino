@@ -143,21 +143,11 @@ void loop() {
         count = 0; // reset
       }
   
-      // convert to HEX
-      char data[] = { '0', '0', 0};
-      data[0] += (count / 16);
-      if(data[0] > '9'){
-        data[0] += 7;
-      }
-      data[1] += (count % 16);
-      if(data[1] > '9'){
-        data[1] += 7;
-      }
-  
-      // send the message
+      // send the message (converted to HEX by the library)
+      uint8_t data = count;
       Serial.print(F("Data: "));
-      Serial.println(data);
-      response = lorawan.sendX(1, data);
+      Serial.println(data, HEX);
+      response = lorawan.sendX(1, &data, 1);
 
       // listen for an incoming message
       timeout = millis() + 10000; // 10 s
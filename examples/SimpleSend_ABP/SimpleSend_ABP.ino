@@ -48,6 +48,12 @@ unsigned long timeout;
 bool joined = false;
 int count = 0;
 
+// the schema of the payload (see <payload_print_decoder()> for the server)
+constexpr PayloadField SCHEMA[] = {
+  PAYLOAD_FIELD("count", 0, 255, 1)
+};
+PayloadEncoder<PAYLOAD_SIZE(SCHEMA)> payload(SCHEMA);
+
 // --------------------------------------------------
 // --------------------------------------------------
 
@@ -143,21 +149,13 @@ void loop() {
         count = 0; // reset
       }
   
-      // convert to HEX
-      char data[] = { '0', '0', 0};
-      data[0] += (count / 16);
-      if(data[0] > '9'){
-        data[0] += 7;
-      }
-      data[1] += (count % 16);
-      if(data[1] > '9'){
-        data[1] += 7;
-      }
+      // pack the data
+      payload.set(0, count);
   
-      // send the message
+      // send the message (converted to HEX by the library)
       Serial.print(F("Data: "));
-      Serial.println(data);
-      response = lorawan.sendX(1, data);
+      Serial.println(count);
+      response = lorawan.sendX(1, payload.data(), payload.size());
   
       // update the timeout
       timeout = millis() + PAUSE_TIME;
@@ -0,0 +1,209 @@
+/*******************************************************************************
+* RoboCore Airtime Library (v1.0)
+*
+* Library to calculate the time on air of the LoRaWAN uplinks (AU915) and to
+* schedule them within the limits of the region.
+*
+* Copyright 2022 RoboCore.
+*
+*
+* This file is part of the SMW_SX1262M0 library ("SMW_SX1262M0-lib").
+*
+* "SMW_SX1262M0-lib" is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* "SMW_SX1262M0-lib" is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with "SMW_SX1262M0-lib". If not, see <https://www.gnu.org/licenses/>
+*******************************************************************************/
+
+// --------------------------------------------------
+// Libraries
+
+#include "Airtime.h"
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+// Get the remaining time of a period
+//  @param (start) : the beginning of the period [ms]
+//         (duration) : the duration of the period [ms]
+//         (now) : the current time [ms]
+//  @returns the remaining time, or 0 if the period has passed [ms]
+//  NOTE: the elapsed time is unsigned, so the overflow of <millis()> is
+//        handled for periods of up to 49 days.
+static inline uint32_t remaining(uint32_t start, uint32_t duration, uint32_t now){
+  uint32_t elapsed = now - start;
+  return (elapsed < duration) ? (duration - elapsed) : 0;
+}
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+// Constructor
+//  @param (dwell) : the maximum time on air of an uplink [ms] (0 to disable)
+//         (duty_cycle) : the maximum fraction of the time on air [%] (0 to disable)
+//         (budget) : the time on air allowed per window [ms] (0 to disable)
+//         (window) : the duration of the window of the budget [ms]
+//         (guard) : the time the module is busy after an uplink (receive windows) [ms]
+//  NOTE: the budget is a leaky bucket, so the time on air is released
+//        gradually along the window.
+AirtimeScheduler::AirtimeScheduler(uint16_t dwell, uint8_t duty_cycle, uint32_t budget, uint32_t window, uint16_t guard) :
+  _dwell(dwell),
+  _duty_cycle((duty_cycle < 100) ? duty_cycle : 0),
+  _budget(budget),
+  _leak_period(0),
+  _guard(guard),
+  _record_time(0),
+  _busy_duration(0),
+  _duty_duration(0),
+  _used(0),
+  _leak_time(0),
+  _last_airtime(0),
+  _last_record_time(0),
+  _last_busy_duration(0),
+  _last_duty_duration(0)
+  {
+  if(_budget > 0){
+    _leak_period = window / _budget;
+    if(_leak_period == 0){
+      _leak_period = 1; // minimum
+    }
+  }
+}
+
+// --------------------------------------------------
+
+// Cancel the last uplink
+//  NOTE: used when the module didn't accept the uplink, so the time on air
+//        was not used.
+void AirtimeScheduler::cancel(void){
+  _record_time = _last_record_time;
+  _busy_duration = _last_busy_duration;
+  _duty_duration = _last_duty_duration;
+  _used = (_used > _last_airtime) ? (_used - _last_airtime) : 0;
+  _last_airtime = 0; // reset
+}
+
+// --------------------------------------------------
+
+// Get the time to wait before an uplink
+//  @param (now) : the current time [ms]
+//         (dr) : the data rate [uint8_t] (0-6, invalid to check only the receive windows)
+//         (length) : the length of the application payload [uint8_t]
+//  @returns the time to wait, or AIRTIME_NEVER if the uplink exceeds the limits [ms]
+uint32_t AirtimeScheduler::delay(uint32_t now, uint8_t dr, uint8_t length){
+  uint32_t toa = _airtime(dr, length);
+  if(toa == AIRTIME_NEVER){
+    return AIRTIME_NEVER;
+  } else if((_budget > 0) && (toa > _budget)){
+    return AIRTIME_NEVER;
+  }
+
+  // check the receive windows and the duty cycle
+  uint32_t wait = remaining(_record_time, _busy_duration, now);
+  uint32_t duty = remaining(_record_time, _duty_duration, now);
+  if(duty > wait){
+    wait = duty;
+  } else if(wait == 0){
+    // no pending period (not checked again after a long idle time)
+    _busy_duration = 0;
+    _duty_duration = 0;
+  }
+
+  // check the budget
+  _leak(now);
+  if((_budget > 0) && ((_used + toa) > _budget)){
+    uint32_t excess = (_used + toa - _budget) * _leak_period - (now - _leak_time);
+    if(excess > wait){
+      wait = excess;
+    }
+  }
+
+  return wait;
+}
+
+// --------------------------------------------------
+
+// Record an uplink
+//  @param (now) : the current time [ms]
+//         (dr) : the data rate [uint8_t] (0-6, invalid to record only the receive windows)
+//         (length) : the length of the application payload [uint8_t]
+void AirtimeScheduler::record(uint32_t now, uint8_t dr, uint8_t length){
+  uint32_t toa = _airtime(dr, length);
+  if(toa == AIRTIME_NEVER){
+    toa = 0; // not checked (must not happen)
+  }
+
+  // store the previous state (see <cancel()>)
+  _last_airtime = (_budget > 0) ? toa : 0;
+  _last_record_time = _record_time;
+  _last_busy_duration = _busy_duration;
+  _last_duty_duration = _duty_duration;
+
+  // update
+  _leak(now);
+  _record_time = now;
+  _busy_duration = toa + _guard;
+  if(_duty_cycle > 0){
+    _duty_duration = toa * 100 / _duty_cycle;
+  }
+  _used += _last_airtime;
+}
+
+// --------------------------------------------------
+
+// Get the time on air used in the window of the budget
+//  @param (now) : the current time [ms]
+//  @returns the time on air [ms]
+uint32_t AirtimeScheduler::used(uint32_t now){
+  _leak(now);
+  return _used;
+}
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+// Get the time on air of an uplink
+//  @param (dr) : the data rate [uint8_t]
+//         (length) : the length of the application payload [uint8_t]
+//  @returns the time on air (0 if the data rate is invalid), or AIRTIME_NEVER if longer than the dwell time [ms]
+uint32_t AirtimeScheduler::_airtime(uint8_t dr, uint8_t length){
+  if(dr > AIRTIME_DR_MAX){
+    return 0; // unknown
+  }
+
+  uint32_t toa = airtime(dr, length); // [us]
+  if((_dwell > 0) && (toa > (_dwell * 1000UL))){
+    return AIRTIME_NEVER;
+  }
+  return (toa + 999) / 1000; // round up
+}
+
+// --------------------------------------------------
+
+// Release the time on air of the budget
+//  @param (now) : the current time [ms]
+void AirtimeScheduler::_leak(uint32_t now){
+  if((_leak_period == 0) || (_used == 0)){
+    _leak_time = now; // reset
+    return;
+  }
+
+  uint32_t released = (now - _leak_time) / _leak_period;
+  if(released >= _used){
+    _used = 0;
+    _leak_time = now;
+  } else {
+    _used -= released;
+    _leak_time += released * _leak_period;
+  }
+}
+
+// --------------------------------------------------
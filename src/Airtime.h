@@ -0,0 +1,149 @@
+#ifndef AIRTIME_H
+#define AIRTIME_H
+
+/*******************************************************************************
+* RoboCore Airtime Library (v1.0)
+*
+* Library to calculate the time on air of the LoRaWAN uplinks (AU915) and to
+* schedule them within the limits of the region.
+*
+* Copyright 2022 RoboCore.
+*
+*
+* This file is part of the SMW_SX1262M0 library ("SMW_SX1262M0-lib").
+*
+* "SMW_SX1262M0-lib" is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* "SMW_SX1262M0-lib" is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with "SMW_SX1262M0-lib". If not, see <https://www.gnu.org/licenses/>
+*******************************************************************************/
+
+// --------------------------------------------------
+// Dependencies
+
+extern "C" {
+  #include <stdint.h>
+}
+
+// --------------------------------------------------
+// Macros
+
+#define AIRTIME_DR_MAX        6 // (DR0-DR5 at 125 kHz, DR6 at 500 kHz)
+#define AIRTIME_NEVER         0xFFFFFFFF // (the uplink can't be sent)
+#define AIRTIME_OVERHEAD     13 // [bytes] (MHDR, FHDR without FOpts, FPort and MIC)
+#define AIRTIME_PREAMBLE     49 // [1/4 symbols] (8 symbols + 4.25 for the synchronization)
+
+// -----------------------------------------------------------------
+
+// Get the spreading factor of a data rate at compile time
+//  @param (dr) : the data rate [uint8_t] (0-6)
+//  @returns the spreading factor [uint8_t]
+constexpr uint8_t airtime_sf(uint8_t dr){
+  return (dr < 6) ? (12 - dr) : 8;
+}
+
+// Get the duration of a symbol at compile time
+//  @param (dr) : the data rate [uint8_t] (0-6)
+//  @returns the duration (2^SF / BW) [us]
+constexpr uint32_t airtime_symbol(uint8_t dr){
+  return (dr < 6) ? (8UL << airtime_sf(dr)) : (2UL << airtime_sf(dr));
+}
+
+// Check if the low data rate optimization is used at compile time
+//  @param (dr) : the data rate [uint8_t] (0-6)
+//  @returns 1 for the symbols of 16 ms or longer, 0 otherwise [uint8_t]
+constexpr uint8_t airtime_ldro(uint8_t dr){
+  return (dr < 2) ? 1 : 0;
+}
+
+// Get the number of bits to code in the payload blocks at compile time
+//  @param (dr) : the data rate [uint8_t] (0-6)
+//         (length) : the length of the application payload [uint8_t]
+//  @returns the number of bits (with the CRC and the explicit header) [int16_t]
+constexpr int16_t airtime_bits(uint8_t dr, uint8_t length){
+  return (8 * (length + AIRTIME_OVERHEAD)) - (4 * airtime_sf(dr)) + 28 + 16;
+}
+
+// Get the number of symbols of the payload at compile time
+//  @param (dr) : the data rate [uint8_t] (0-6)
+//         (length) : the length of the application payload [uint8_t]
+//  @returns the number of symbols (coding rate 4/5) [uint16_t]
+constexpr uint16_t airtime_symbols(uint8_t dr, uint8_t length){
+  return 8 + ((airtime_bits(dr, length) <= 0) ? 0 :
+    (((airtime_bits(dr, length) + (4 * (airtime_sf(dr) - 2 * airtime_ldro(dr))) - 1) /
+      (4 * (airtime_sf(dr) - 2 * airtime_ldro(dr)))) * 5));
+}
+
+// Get the time on air of an uplink at compile time
+//  @param (dr) : the data rate [uint8_t] (0-6)
+//         (length) : the length of the application payload [uint8_t]
+//  @returns the time on air [us]
+//  NOTE: the calculation follows the datasheet of the SX1262, with the
+//        settings of LoRaWAN (8 symbols of preamble, explicit header, CRC and
+//        coding rate 4/5).
+constexpr uint32_t airtime(uint8_t dr, uint8_t length){
+  return ((AIRTIME_PREAMBLE * airtime_symbol(dr)) / 4) + (airtime_symbols(dr, length) * airtime_symbol(dr));
+}
+
+// Get the maximum application payload of a data rate (without dwell time) at compile time
+//  @param (dr) : the data rate [uint8_t] (0-6)
+//  @returns the maximum length [bytes]
+constexpr uint8_t airtime_max_length(uint8_t dr){
+  return (dr < 3) ? 51 : ((dr == 3) ? 115 : 242);
+}
+
+// Get the maximum application payload of a data rate at compile time
+//  @param (dr) : the data rate [uint8_t] (0-6)
+//         (dwell) : the dwell time [ms] (0 to disable)
+//         (length) : the first length to check [uint8_t] (default: the maximum of the data rate)
+//  @returns the maximum length, or 0 if no uplink fits the dwell time [bytes]
+constexpr uint8_t airtime_max_payload(uint8_t dr, uint16_t dwell, uint8_t length = 0xFF){
+  return (length == 0xFF) ? airtime_max_payload(dr, dwell, airtime_max_length(dr)) :
+    (((length == 0) || (dwell == 0) || (airtime(dr, length) <= (dwell * 1000UL))) ? length :
+      airtime_max_payload(dr, dwell, length - 1));
+}
+
+// -----------------------------------------------------------------
+
+// The scheduler of the uplinks
+//  NOTE: the time is given by the caller (<millis()>), so the scheduler can
+//        be used without a module.
+class AirtimeScheduler {
+  public:
+    AirtimeScheduler(uint16_t, uint8_t, uint32_t, uint32_t, uint16_t);
+    void cancel(void);
+    uint32_t delay(uint32_t, uint8_t, uint8_t);
+    void record(uint32_t, uint8_t, uint8_t);
+    uint32_t used(uint32_t);
+
+  private:
+    uint16_t _dwell;
+    uint8_t _duty_cycle;
+    uint32_t _budget;
+    uint32_t _leak_period;
+    uint16_t _guard;
+    uint32_t _record_time;
+    uint32_t _busy_duration;
+    uint32_t _duty_duration;
+    uint32_t _used;
+    uint32_t _leak_time;
+    uint32_t _last_airtime;
+    uint32_t _last_record_time;
+    uint32_t _last_busy_duration;
+    uint32_t _last_duty_duration;
+
+    uint32_t _airtime(uint8_t, uint8_t);
+    void _leak(uint32_t);
+};
+
+// -----------------------------------------------------------------
+
+#endif // AIRTIME_H
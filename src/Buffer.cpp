@@ -1,5 +1,5 @@
 /*******************************************************************************
-* RoboCore Buffer Library (v1.1)
+* RoboCore Buffer Library (v1.3)
 * 
 * Library to manipulate buffers.
 * 
@@ -44,14 +44,16 @@ Buffer::Buffer() : Buffer(1) {
 // --------------------------------------------------
 
 // Constructor
-//  @param (size) : the size of the buffer in bytes [uint8_t]
-Buffer::Buffer(uint8_t size) :
-  _size(size)
+//  @param (size) : the size of the buffer in bytes [buffer_size_t]
+Buffer::Buffer(buffer_size_t size) :
+  _size(size),
+  _owner(true)
   {
   // check the size
   if(_size == 0){
     _size = 1; // force the minimum size
   }
+  _capacity = _size;
     
 //  _buffer = (uint8_t *)malloc(_size * sizeof(uint8_t)); // 15/04/20 : old version
   _buffer = new uint8_t[_size]; // allocate the memory
@@ -60,24 +62,73 @@ Buffer::Buffer(uint8_t size) :
 
 // --------------------------------------------------
 
+// Constructor (external storage)
+//  @param (storage) : the memory of the buffer [uint8_t *]
+//         (size) : the size of the memory in bytes [buffer_size_t]
+//  NOTE: the memory is not freed by the buffer (see <StaticBuffer>).
+Buffer::Buffer(uint8_t *storage, buffer_size_t size) :
+  _size(size),
+  _capacity(size),
+  _owner(false),
+  _buffer(storage)
+  {
+  reset();
+}
+
+// --------------------------------------------------
+
 // Copy constructor
 //  @param (buffer) : the buffer to copy [Buffer]
 Buffer::Buffer(const Buffer& buffer) :
+  _head(buffer._head),
   _index(buffer._index),
-  _size(buffer._size)
+  _size(buffer._size),
+  _capacity(buffer._size),
+  _owner(true)
   {
-  _buffer = new uint8_t[_size]; // allocate the memory
-  for(uint8_t i=0 ; i < _size ; i++){
+  _buffer = (_size > 0) ? new uint8_t[_size] : nullptr; // allocate the memory (if not empty)
+  for(buffer_size_t i=0 ; i < _size ; i++){
     _buffer[i] = buffer._buffer[i];
   }
 }
 
 // --------------------------------------------------
 
+// Move constructor
+//  @param (buffer) : the buffer to move [Buffer]
+//  NOTE: the memory is taken from <buffer>, which is left empty (without
+//        memory and with a size of 0 bytes, see <resize()>). The data is
+//        copied if <buffer> doesn't own its memory.
+Buffer::Buffer(Buffer&& buffer) :
+  _head(buffer._head),
+  _index(buffer._index),
+  _size(buffer._size),
+  _capacity(buffer._size),
+  _owner(true)
+  {
+  if(buffer._owner){
+    _buffer = buffer._buffer; // take the memory
+    buffer._buffer = nullptr; // no allocation
+    buffer._head = 0;
+    buffer._index = 0;
+    buffer._size = 0;
+    buffer._capacity = 0;
+  } else {
+    _buffer = new uint8_t[_size]; // allocate the memory
+    for(buffer_size_t i=0 ; i < _size ; i++){
+      _buffer[i] = buffer._buffer[i];
+    }
+  }
+}
+
+// --------------------------------------------------
+
 // Destructor
 Buffer::~Buffer(){
 //  free(_buffer); // 15/04/20 : old version
-  delete[] _buffer; // free the memory
+  if(_owner){
+    delete[] _buffer; // free the memory
+  }
 }
 
 // --------------------------------------------------
@@ -89,14 +140,37 @@ Buffer& Buffer::operator=(const Buffer& buffer){
     return *this;
   }
 
-  if(_buffer){
+  // check the size
+  if(!_owner){
+    _size = (buffer._size < _capacity) ? buffer._size : _capacity; // limited by the storage
+  } else if(_size != buffer._size){
     delete[] _buffer;
+    _size = buffer._size;
+    _capacity = _size;
+    _buffer = (_size > 0) ? new uint8_t[_size] : nullptr; // allocate the memory (if not empty)
   }
-  _size = buffer._size;
-  _index = buffer._index;
-  _buffer = new uint8_t[_size]; // allocate the memory
-  for(uint8_t i=0 ; i < _size ; i++){
-    _buffer[i] = buffer._buffer[i];
+
+  // copy the data (from the head)
+  _head = 0;
+  _index = (buffer._index < _size) ? buffer._index : _size;
+  for(buffer_size_t i=0 ; i < _size ; i++){
+    _buffer[i] = (i < _index) ? buffer._buffer[buffer._position(i)] : 0;
+  }
+
+  return *this;
+}
+
+// --------------------------------------------------
+
+// Operator = (move assignment)
+//  NOTE: the memory is exchanged when both buffers own their memory,
+//        otherwise the data is copied.
+Buffer& Buffer::operator=(Buffer&& buffer){
+  if(_owner && buffer._owner){
+    swap(buffer);
+    buffer.reset();
+  } else {
+    *this = static_cast<const Buffer&>(buffer); // copy
   }
 
   return *this;
@@ -106,13 +180,21 @@ Buffer& Buffer::operator=(const Buffer& buffer){
 
 // Operator [] (subscript)
 //  @returns the value of the last index if out of bounds [const uint8_t]
-const uint8_t& Buffer::operator[](uint8_t index) const {
+const uint8_t& Buffer::operator[](buffer_size_t index) const {
+  static const uint8_t empty = 0;
+
   // check the index
   if(index >= _index){
-    return _buffer[_index - 1]; // return from the last index
+    if(_size == 0){
+      return empty; // no memory (moved from)
+    }
+    if(_index == 0){
+      return _buffer[_head]; // empty
+    }
+    return _buffer[_position(_index - 1)]; // return from the last index
   }
 
-  return _buffer[index];
+  return _buffer[_position(index)];
 }
 
 // --------------------------------------------------
@@ -122,7 +204,8 @@ const uint8_t& Buffer::operator[](uint8_t index) const {
 //  @param (b) the byte to append [uint8_t]
 void Buffer::append(uint8_t b){
   if(!isFull()){
-    _buffer[_index++] = b;
+    _buffer[_position(_index)] = b;
+    _index++; // update
   }
   if(_index > _size){
     _index = _size; // udpate
@@ -132,8 +215,8 @@ void Buffer::append(uint8_t b){
 // --------------------------------------------------
 
 // Check if there is data available
-//  @returns the quantity of bytes stored [uint8_t]
-uint8_t Buffer::available(void){
+//  @returns the quantity of bytes stored [buffer_size_t]
+buffer_size_t Buffer::available(void){
   return _index;
 }
 
@@ -142,7 +225,32 @@ uint8_t Buffer::available(void){
 // Get a copy of the buffer
 //  @param (data) : the array to copy to [uint8_t *]
 void Buffer::copy(uint8_t *data){
-  memcpy(data, _buffer, _index);
+  if(_index == 0){
+    return; // empty
+  }
+
+  buffer_size_t length;
+  const uint8_t *first = span(length);
+  memcpy(data, first, length);
+  memcpy(data + length, _buffer, _index - length); // wrapped data (if any)
+}
+
+// --------------------------------------------------
+
+// Get the stored data
+//  @returns the pointer to the first byte [const uint8_t *]
+//  NOTE: the pointer is valid until the buffer is modified. If the data
+//        wraps around the end of the buffer, it is rotated in place to be
+//        contiguous (use <span()> to avoid it).
+const uint8_t * Buffer::data(void){
+  if(_head > 0){
+    // rotate the buffer to start at index 0
+    _reverse(0, _head);
+    _reverse(_head, _size);
+    _reverse(0, _size);
+    _head = 0;
+  }
+  return _buffer;
 }
 
 // --------------------------------------------------
@@ -165,7 +273,7 @@ uint8_t Buffer::peek(void){
     return 0;
   }
 
-  return _buffer[0];
+  return _buffer[_head];
 }
 
 
@@ -181,8 +289,8 @@ void Buffer::print(Stream *stream){
     stream->print('|');
     stream->print(_index); // is the same as <available()>
     stream->print('|');
-    for(uint8_t i=0 ; i < _index ; i++){
-      stream->write(_buffer[i]);
+    for(buffer_size_t i=0 ; i < _index ; i++){
+      stream->write(_buffer[_position(i)]);
     }
     stream->println();
   }
@@ -196,13 +304,11 @@ void Buffer::print(Stream *stream){
 uint8_t Buffer::read(void){
   uint8_t ret = peek();
 
-  // shift the buffer
+  // advance the head (no shift)
   if(_index > 0){
-    for(uint8_t i=0 ; i < (_index - 1) ; i++){
-      _buffer[i] = _buffer[i+1];
-    }
+    _buffer[_head] = 0; // reset
+    _head = _position(1);
     _index--; // update
-    _buffer[_index] = 0; // reset
   }
   
   return ret;
@@ -211,27 +317,34 @@ uint8_t Buffer::read(void){
 // --------------------------------------------------
 
 // Remove a byte from the buffer
-//  @param (index) : the index to remove [uint8_t]
-void Buffer::remove(uint8_t index){
+//  @param (index) : the index to remove [buffer_size_t]
+void Buffer::remove(buffer_size_t index){
   // check the index
   if(index >= _index){
     return;
   }
 
-  // shift the buffer
-  for(uint8_t i=index ; i < (_index - 1) ; i++){
-    _buffer[i] = _buffer[i+1];
+  // check for the first byte
+  if(index == 0){
+    read();
+    return;
+  }
+
+  // shift the rest of the buffer
+  for(buffer_size_t i=index ; i < (_index - 1) ; i++){
+    _buffer[_position(i)] = _buffer[_position(i+1)];
   }
   _index--; // update
-  _buffer[_index] = 0; // reset
+  _buffer[_position(_index)] = 0; // reset
 }
 
 // --------------------------------------------------
 
 // Reset the buffer
 void Buffer::reset(void){
+  _head = 0;
   _index = 0;
-  for(uint8_t i=0 ; i < _size ; i++){
+  for(buffer_size_t i=0 ; i < _size ; i++){
     _buffer[i] = 0;
   }
 }
@@ -240,23 +353,44 @@ void Buffer::reset(void){
 // --------------------------------------------------
 
 // Resize the buffer
-//  @param (size) : the size of the buffer in bytes [uint8_t]
-void Buffer::resize(uint8_t size){
+//  @param (size) : the size of the buffer in bytes [buffer_size_t]
+//  NOTE: a buffer left empty by a move is allocated again.
+void Buffer::resize(buffer_size_t size){
   // check the new size
   if(size == 0){
     return;
   }
+
+  // check for external storage
+  if(!_owner){
+    if(size > _capacity){
+      size = _capacity; // limited by the storage
+    }
+    data(); // start at index 0
+    for(buffer_size_t i=_index ; i < size ; i++){
+      _buffer[i] = 0;
+    }
+    if(_index > size){
+      _index = size;
+    }
+    _size = size;
+    return;
+  }
   
   // allocate the memory
   uint8_t *_new_buffer = new uint8_t[size];
 
-  // copy the data
-  uint8_t copy_size = (size < _size) ? size : _size;
-  for(uint8_t i=0 ; i < copy_size ; i++){
-    _new_buffer[i] = _buffer[i];
+  // copy the data (from the head)
+  buffer_size_t copy_size = (size < _size) ? size : _size;
+  for(buffer_size_t i=0 ; i < copy_size ; i++){
+    _new_buffer[i] = _buffer[_position(i)];
+  }
+  for(buffer_size_t i=copy_size ; i < size ; i++){
+    _new_buffer[i] = 0;
   }
 
   // validate the index
+  _head = 0;
   if(_index > size){
     _index = size;
   }
@@ -265,14 +399,120 @@ void Buffer::resize(uint8_t size){
   delete[] _buffer;
   _buffer = _new_buffer;
   _size = size;
+  _capacity = size;
 }
 
 // --------------------------------------------------
 
 // Get the size of the buffer
-//  @returns the size of the buffer [uint8_t]
-uint8_t Buffer::size(void){
+//  @returns the size of the buffer [buffer_size_t]
+buffer_size_t Buffer::size(void){
   return _size;
 }
 
 // --------------------------------------------------
+
+// Get the first contiguous part of the stored data
+//  @param (length) : the variable to store the length of the part [buffer_size_t (&)]
+//  @returns the pointer to the first byte [const uint8_t *]
+//  NOTE: if the data wraps around the end of the buffer, the rest is at the
+//        start of the buffer (use <read()> or <remove()> to consume the part).
+const uint8_t * Buffer::span(buffer_size_t (&length)){
+  buffer_size_t until_end = _size - _head;
+  length = (_index < until_end) ? _index : until_end;
+  return _buffer + _head;
+}
+
+// --------------------------------------------------
+
+// Exchange the data with another buffer
+//  @param (buffer) : the other buffer [Buffer]
+//  NOTE: the memory is exchanged when both buffers own their memory (no copy).
+//        Otherwise the data is exchanged byte by byte, without allocation, and
+//        truncated to the size of each buffer.
+void Buffer::swap(Buffer& buffer){
+  if(this == &buffer){
+    return;
+  }
+
+  // exchange the memory
+  if(_owner && buffer._owner){
+    uint8_t *temp_buffer = _buffer;
+    _buffer = buffer._buffer;
+    buffer._buffer = temp_buffer;
+    buffer_size_t temp = _head;
+    _head = buffer._head;
+    buffer._head = temp;
+    temp = _index;
+    _index = buffer._index;
+    buffer._index = temp;
+    temp = _size;
+    _size = buffer._size;
+    buffer._size = temp;
+    temp = _capacity;
+    _capacity = buffer._capacity;
+    buffer._capacity = temp;
+    return;
+  }
+
+  // exchange the data
+  data(); // start at index 0
+  buffer.data(); // start at index 0
+  buffer_size_t length = (_index > buffer._index) ? _index : buffer._index;
+  for(buffer_size_t i=0 ; i < length ; i++){
+    uint8_t mine = (i < _index) ? _buffer[i] : 0;
+    uint8_t other = (i < buffer._index) ? buffer._buffer[i] : 0;
+    if(i < _size){
+      _buffer[i] = other;
+    }
+    if(i < buffer._size){
+      buffer._buffer[i] = mine;
+    }
+  }
+  length = _index;
+  _index = (buffer._index < _size) ? buffer._index : _size;
+  buffer._index = (length < buffer._size) ? length : buffer._size;
+}
+
+// --------------------------------------------------
+
+// Truncate the buffer
+//  @param (length) : the quantity of bytes to keep [buffer_size_t]
+void Buffer::truncate(buffer_size_t length){
+  // check the length
+  if(length >= _index){
+    return;
+  }
+
+  _index = length; // update
+}
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+// Get the position of an index in the memory
+//  @param (index) : the index from the first byte [buffer_size_t]
+//  @returns the position in the memory [buffer_size_t]
+buffer_size_t Buffer::_position(buffer_size_t index) const {
+  if(index >= (_size - _head)){
+    return index - (_size - _head); // wrap around
+  }
+  return _head + index;
+}
+
+// --------------------------------------------------
+
+// Reverse a part of the memory
+//  @param (start) : the first position [buffer_size_t]
+//         (end) : the position after the last one [buffer_size_t]
+void Buffer::_reverse(buffer_size_t start, buffer_size_t end){
+  while((start + 1) < end){
+    end--;
+    uint8_t temp = _buffer[start];
+    _buffer[start] = _buffer[end];
+    _buffer[end] = temp;
+    start++;
+  }
+}
+
+// --------------------------------------------------
@@ -2,7 +2,7 @@
 #define BUFFER_H
 
 /*******************************************************************************
-* RoboCore Buffer Library (v1.1)
+* RoboCore Buffer Library (v1.3)
 * 
 * Library to manipulate buffers.
 * 
@@ -27,6 +27,7 @@
 *******************************************************************************/
 
 #define BUFFER_DEBUG
+// #define BUFFER_SIZE_TYPE size_t // type of the size and of the indices (default: uint16_t)
 
 // --------------------------------------------------
 // Dependencies
@@ -36,40 +37,84 @@
 #endif
 
 extern "C" {
+  #include <stddef.h>
   #include <stdint.h>
 }
 
+#ifndef BUFFER_SIZE_TYPE
+#define BUFFER_SIZE_TYPE uint16_t
+#endif
+
+typedef BUFFER_SIZE_TYPE buffer_size_t;
+
 // -----------------------------------------------------------------
 
 class Buffer {
   public:
     Buffer();
-    Buffer(uint8_t);
+    Buffer(buffer_size_t);
     Buffer(const Buffer&);
+    Buffer(Buffer&&);
     ~Buffer();
     void append(uint8_t);
-    uint8_t available(void);
+    buffer_size_t available(void);
     void copy(uint8_t *);
+    const uint8_t * data(void);
     bool isFull(void);
     uint8_t peek(void);
     uint8_t read(void);
-    void remove(uint8_t);
+    void remove(buffer_size_t);
     void reset(void);
-    void resize(uint8_t);
-    uint8_t size(void);
+    void resize(buffer_size_t);
+    buffer_size_t size(void);
+    const uint8_t * span(buffer_size_t (&));
+    void swap(Buffer&);
+    void truncate(buffer_size_t);
 
     Buffer& operator=(const Buffer&);
+    Buffer& operator=(Buffer&&);
 
-    const uint8_t& operator[](uint8_t) const;
+    const uint8_t& operator[](buffer_size_t) const;
 
 #ifdef BUFFER_DEBUG
     void print(Stream *);
 #endif
+
+  protected:
+    Buffer(uint8_t *, buffer_size_t);
   
   private:
-    uint8_t _index;
-    uint8_t _size;
+    buffer_size_t _head;
+    buffer_size_t _index;
+    buffer_size_t _size;
+    buffer_size_t _capacity;
+    bool _owner;
     uint8_t *_buffer;
+
+    buffer_size_t _position(buffer_size_t) const;
+    void _reverse(buffer_size_t, buffer_size_t);
+};
+
+// -----------------------------------------------------------------
+
+// The storage of a static buffer (initialized before the buffer)
+template <buffer_size_t N>
+struct StaticBufferStorage {
+  uint8_t _storage[N];
+};
+
+// A buffer with inline storage (no heap allocation)
+//  NOTE: it can be used wherever a <Buffer> is expected, but it can't be
+//        resized above N bytes.
+template <buffer_size_t N>
+class StaticBuffer : private StaticBufferStorage<N>, public Buffer {
+  public:
+    StaticBuffer() : Buffer(this->_storage, N) {}
+    StaticBuffer(const StaticBuffer& buffer) : Buffer(this->_storage, N) { Buffer::operator=(buffer); }
+    StaticBuffer(const Buffer& buffer) : Buffer(this->_storage, N) { Buffer::operator=(buffer); }
+
+    StaticBuffer& operator=(const StaticBuffer& buffer){ Buffer::operator=(buffer); return *this; }
+    StaticBuffer& operator=(const Buffer& buffer){ Buffer::operator=(buffer); return *this; }
 };
 
 // -----------------------------------------------------------------
@@ -0,0 +1,192 @@
+/*******************************************************************************
+* RoboCore Hexadecimal Codec Library (v1.0)
+*
+* Library to convert binary data to and from hexadecimal text.
+*
+* Copyright 2022 RoboCore.
+*
+*
+* This file is part of the SMW_SX1262M0 library ("SMW_SX1262M0-lib").
+*
+* "SMW_SX1262M0-lib" is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* "SMW_SX1262M0-lib" is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with "SMW_SX1262M0-lib". If not, see <https://www.gnu.org/licenses/>
+*******************************************************************************/
+
+// --------------------------------------------------
+// Libraries
+
+#include "HexCodec.h"
+
+// --------------------------------------------------
+// Dependencies
+
+extern "C" {
+  #include <string.h>
+}
+
+// --------------------------------------------------
+// Tables
+
+// The characters of the nibbles
+static const char HEX_DIGITS[16] = {
+  '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+// The values of the characters, indexed by the lower 5 bits of the character
+//  NOTE: '0'-'9' map to 0x10-0x19 and 'A'-'F'/'a'-'f' to 0x01-0x06.
+//        Invalid entries are 0xFF, but the class of the character must also be
+//        checked (see <hex_value()>).
+static const uint8_t HEX_VALUES[32] = {
+  0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+// --------------------------------------------------
+
+// Get the value of an hexadecimal character
+//  @param (c) : the character [char]
+//  @returns the value of the nibble, or 0xFF if invalid [uint8_t]
+static inline uint8_t hex_value(char c){
+  uint8_t uc = static_cast<uint8_t>(c);
+  uint8_t group = uc & 0xE0; // 0x20 for the digits, 0x40/0x60 for the letters
+  uint8_t value = HEX_VALUES[uc & 0x1F];
+  if(group == 0x20){
+    return (value <= 0x09) ? value : 0xFF;
+  } else if((group == 0x40) || (group == 0x60)){
+    return ((value >= 0x0A) && (value != 0xFF)) ? value : 0xFF;
+  }
+  return 0xFF;
+}
+
+// --------------------------------------------------
+
+#ifdef HEX_CODEC_SWAR
+
+static const uint64_t SWAR_ONES = 0x0101010101010101ULL;
+static const uint64_t SWAR_HIGH = 0x8080808080808080ULL;
+
+// Check the bytes of a word between two values (exclusive) (SWAR)
+//  @param (x) : the word [uint64_t]
+//         (m) : the lower limit [uint8_t] (0-127)
+//         (n) : the upper limit [uint8_t] (0-128)
+//  @returns the high bit of each byte set if the byte is in range [uint64_t]
+static inline uint64_t swar_between(uint64_t x, uint8_t m, uint8_t n){
+  return ((SWAR_ONES * (127 + n) - (x & (SWAR_ONES * 127))) & ~x &
+    ((x & (SWAR_ONES * 127)) + (SWAR_ONES * (127 - m)))) & SWAR_HIGH;
+}
+
+// Decode 8 hexadecimal characters (SWAR)
+//  @param (output) : the array to store the 4 bytes [uint8_t *]
+//         (input) : the 8 characters [char *]
+//  @returns true if the characters are valid [bool]
+static inline bool swar_decode(uint8_t *output, const char *input){
+  uint64_t x;
+  memcpy(&x, input, 8);
+
+  // validate
+  uint64_t digits = swar_between(x, '0' - 1, '9' + 1);
+  uint64_t letters = swar_between(x | (SWAR_ONES * 0x20), 'a' - 1, 'f' + 1);
+  if((digits | letters) != SWAR_HIGH){
+    return false;
+  }
+
+  // convert to nibbles (+9 for the letters) and pack the pairs
+  uint64_t nibbles = (x & (SWAR_ONES * 0x0F)) + ((letters >> 7) * 9);
+  uint64_t packed = ((nibbles & 0x00FF00FF00FF00FFULL) << 4) | ((nibbles >> 8) & 0x00FF00FF00FF00FFULL);
+  output[0] = packed;
+  output[1] = packed >> 16;
+  output[2] = packed >> 32;
+  output[3] = packed >> 48;
+  return true;
+}
+
+// Encode 4 bytes (SWAR)
+//  @param (output) : the array to store the 8 characters [char *]
+//         (input) : the 4 bytes [uint8_t *]
+static inline void swar_encode(char *output, const uint8_t *input){
+  uint64_t x = static_cast<uint64_t>(input[0]) | (static_cast<uint64_t>(input[1]) << 16) |
+    (static_cast<uint64_t>(input[2]) << 32) | (static_cast<uint64_t>(input[3]) << 48);
+
+  // spread the nibbles (high nibble first) and convert to ASCII
+  uint64_t nibbles = ((x >> 4) & 0x000F000F000F000FULL) | ((x & 0x000F000F000F000FULL) << 8);
+  uint64_t letters = ((nibbles + (SWAR_ONES * 0x76)) >> 7) & SWAR_ONES; // nibble > 9
+  x = nibbles + (SWAR_ONES * '0') + (letters * 7);
+  memcpy(output, &x, 8);
+}
+
+#endif
+
+// -----------------------------------------------------------------
+
+// Decode an hexadecimal text
+//  @param (output) : the array to store the bytes [uint8_t *]
+//         (capacity) : the size of the array [size_t]
+//         (input) : the hexadecimal text [char *]
+//         (length) : the length of the text [size_t]
+//  @returns the number of decoded bytes [size_t]
+//  NOTE: the decoding stops at the first invalid character, at the end of
+//        the array or at an incomplete byte.
+size_t hex_decode(uint8_t *output, size_t capacity, const char *input, size_t length){
+  size_t count = 0;
+
+#ifdef HEX_CODEC_SWAR
+  while(((count + 4) <= capacity) && (length >= 8)){
+    if(!swar_decode(output + count, input)){
+      break; // check with the default method
+    }
+    count += 4;
+    input += 8;
+    length -= 8;
+  }
+#endif
+
+  while((count < capacity) && (length >= 2)){
+    uint8_t high = hex_value(input[0]);
+    uint8_t low = hex_value(input[1]);
+    if((high | low) & 0xF0){
+      break; // invalid character
+    }
+    output[count++] = (high << 4) | low;
+    input += 2;
+    length -= 2;
+  }
+
+  return count;
+}
+
+// --------------------------------------------------
+
+// Encode binary data as hexadecimal text
+//  @param (output) : the array to store the text (2 characters per byte) [char *]
+//         (input) : the bytes to encode [uint8_t *]
+//         (length) : the number of bytes [size_t]
+//  NOTE: the text is upper case and is not NULL terminated.
+void hex_encode(char *output, const uint8_t *input, size_t length){
+#ifdef HEX_CODEC_SWAR
+  while(length >= 4){
+    swar_encode(output, input);
+    output += 8;
+    input += 4;
+    length -= 4;
+  }
+#endif
+
+  while(length > 0){
+    *output++ = HEX_DIGITS[*input >> 4];
+    *output++ = HEX_DIGITS[*input & 0x0F];
+    input++;
+    length--;
+  }
+}
+
+// --------------------------------------------------
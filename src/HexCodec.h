@@ -0,0 +1,51 @@
+#ifndef HEX_CODEC_H
+#define HEX_CODEC_H
+
+/*******************************************************************************
+* RoboCore Hexadecimal Codec Library (v1.0)
+*
+* Library to convert binary data to and from hexadecimal text.
+*
+* Copyright 2022 RoboCore.
+*
+*
+* This file is part of the SMW_SX1262M0 library ("SMW_SX1262M0-lib").
+*
+* "SMW_SX1262M0-lib" is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* "SMW_SX1262M0-lib" is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with "SMW_SX1262M0-lib". If not, see <https://www.gnu.org/licenses/>
+*******************************************************************************/
+
+// --------------------------------------------------
+// Dependencies
+
+extern "C" {
+  #include <stddef.h>
+  #include <stdint.h>
+}
+
+// --------------------------------------------------
+// Macros
+
+// process 8 characters at once with 64-bit words on host builds (SWAR)
+#if !defined(ARDUINO) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define HEX_CODEC_SWAR
+#endif
+
+// -----------------------------------------------------------------
+
+size_t hex_decode(uint8_t *, size_t, const char *, size_t);
+void hex_encode(char *, const uint8_t *, size_t);
+
+// -----------------------------------------------------------------
+
+#endif // HEX_CODEC_H
@@ -0,0 +1,88 @@
+/*******************************************************************************
+* RoboCore Pattern Matcher Library (v1.0)
+*
+* Library to search a stream for multiple patterns at once (Aho-Corasick).
+*
+* Copyright 2022 RoboCore.
+*
+*
+* This file is part of the SMW_SX1262M0 library ("SMW_SX1262M0-lib").
+*
+* "SMW_SX1262M0-lib" is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* "SMW_SX1262M0-lib" is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with "SMW_SX1262M0-lib". If not, see <https://www.gnu.org/licenses/>
+*******************************************************************************/
+
+// --------------------------------------------------
+// Libraries
+
+#include "PatternMatcher.h"
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+// Constructor (default)
+PatternMatcher::PatternMatcher() :
+  _nodes(nullptr),
+  _alphabet(nullptr),
+  _next(nullptr),
+  _width(0),
+  _node(0),
+  _position(0)
+  {
+}
+
+// --------------------------------------------------
+
+// Match the next byte of the stream
+//  @param (c) : the incoming byte [uint8_t]
+//  @returns the index of the pattern that ends at this byte, or PATTERN_NONE [uint8_t]
+//  NOTE: all the patterns are checked at once with a single transition per
+//        byte (the failure nodes are resolved at compile time). A byte out of
+//        the alphabet returns to the root.
+uint8_t PatternMatcher::match(uint8_t c){
+  if(_position < 0xFF){
+    _position++; // update
+  }
+  if(_nodes == nullptr){
+    return PATTERN_NONE;
+  }
+
+  // get the index of the character in the alphabet
+  uint8_t index = 0;
+  while((index < _width) && (static_cast<uint8_t>(pattern_read(&_alphabet[index])) != c)){
+    index++;
+  }
+
+  // go to the next node
+  _node = (index < _width) ? pattern_read(&_next[(_node * _width) + index]) : 0;
+  return pattern_read(&_nodes[_node].match);
+}
+
+// --------------------------------------------------
+
+// Get the number of bytes since the last reset
+//  @returns the number of bytes [uint8_t]
+//  NOTE: a match ends at the last byte, so it starts at (position - length).
+uint8_t PatternMatcher::position(void){
+  return _position;
+}
+
+// --------------------------------------------------
+
+// Reset the matcher
+void PatternMatcher::reset(void){
+  _node = 0;
+  _position = 0;
+}
+
+// --------------------------------------------------
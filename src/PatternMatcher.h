@@ -0,0 +1,332 @@
+#ifndef PATTERN_MATCHER_H
+#define PATTERN_MATCHER_H
+
+/*******************************************************************************
+* RoboCore Pattern Matcher Library (v1.0)
+*
+* Library to search a stream for multiple patterns at once (Aho-Corasick).
+*
+* Copyright 2022 RoboCore.
+*
+*
+* This file is part of the SMW_SX1262M0 library ("SMW_SX1262M0-lib").
+*
+* "SMW_SX1262M0-lib" is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* "SMW_SX1262M0-lib" is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with "SMW_SX1262M0-lib". If not, see <https://www.gnu.org/licenses/>
+*******************************************************************************/
+
+// --------------------------------------------------
+// Dependencies
+
+extern "C" {
+  #include <stdint.h>
+}
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#endif
+
+// --------------------------------------------------
+// Macros
+
+#define PATTERN_NONE 0xFF // (no pattern or no node)
+
+#if defined(__AVR__)
+#define PATTERN_PROGMEM PROGMEM // (the automatons are stored in the flash)
+#define pattern_read(address) pgm_read_byte(address)
+#else
+#define PATTERN_PROGMEM
+#define pattern_read(address) (*(address))
+#endif
+
+// -----------------------------------------------------------------
+
+// A node of the automaton (a prefix of a pattern)
+//  NOTE: the nodes that duplicate the prefix of a previous pattern are unused
+//        (their parent is PATTERN_NONE).
+struct PatternNode {
+  char character; // the last character of the prefix
+  uint8_t parent; // the node of the prefix without the last character
+  uint8_t fail; // the node of the longest proper suffix that is also a prefix
+  uint8_t match; // the pattern that ends at the node, or PATTERN_NONE
+};
+
+// The automaton, generated at compile time
+//  NOTE: the node 0 is the root (empty prefix) and the nodes of each pattern
+//        follow in order, one per character. The transitions are dense over
+//        the alphabet of the patterns (the distinct characters, in order of
+//        appearance), with the failure nodes already followed, so each byte
+//        takes a single transition. Declare the automaton with PATTERN_PROGMEM,
+//        because it is read from the flash on AVR.
+template <uint8_t N, uint8_t A>
+struct PatternTable {
+  PatternNode nodes[N];
+  char alphabet[A];
+  uint8_t next[N * A]; // the next node of each node and character of the alphabet
+};
+
+// -----------------------------------------------------------------
+
+// Get the length of a pattern at compile time
+//  @param (str) : the pattern [char *]
+//  @returns the length of the pattern [uint8_t]
+constexpr uint8_t pattern_length(const char *str){
+  return (*str == '\0') ? 0 : (1 + pattern_length(str + 1));
+}
+
+// Get the first node of a pattern at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (index) : the index of the pattern [uint8_t]
+//  @returns the index of the node [uint8_t]
+//  NOTE: the first node after the last pattern is the number of nodes.
+constexpr uint8_t pattern_offset(const char* const *patterns, uint8_t index){
+  return (index == 0) ? 1 : (pattern_offset(patterns, index - 1) + pattern_length(patterns[index - 1]));
+}
+
+// Compare the prefixes of two patterns at compile time
+//  @param (str1) : the first pattern [char *]
+//         (str2) : the second pattern [char *]
+//         (length) : the length of the prefix [uint8_t]
+//  @returns true if the prefixes are equal [bool]
+constexpr bool pattern_same(const char *str1, const char *str2, uint8_t length){
+  return (length == 0) || ((*str1 == *str2) && pattern_same(str1 + 1, str2 + 1, length - 1));
+}
+
+// Get the first pattern with the same prefix at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (index) : the index of the pattern [uint8_t]
+//         (length) : the length of the prefix [uint8_t]
+//         (first) : the first pattern to check [uint8_t] (default: 0)
+//  @returns the index of the pattern [uint8_t]
+constexpr uint8_t pattern_owner(const char* const *patterns, uint8_t index, uint8_t length, uint8_t first = 0){
+  return (first >= index) ? index :
+    (((pattern_length(patterns[first]) >= length) && pattern_same(patterns[first], patterns[index], length)) ?
+      first : pattern_owner(patterns, index, length, first + 1));
+}
+
+// Get the node of a prefix at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (index) : the index of the pattern [uint8_t]
+//         (length) : the length of the prefix [uint8_t]
+//  @returns the index of the node [uint8_t]
+constexpr uint8_t pattern_node(const char* const *patterns, uint8_t index, uint8_t length){
+  return (length == 0) ? 0 : (pattern_offset(patterns, pattern_owner(patterns, index, length)) + length - 1);
+}
+
+// Get the pattern of a node at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (node) : the index of the node [uint8_t]
+//         (index) : the first pattern to check [uint8_t] (default: 0)
+//  @returns the index of the pattern [uint8_t]
+//  NOTE: the root belongs to the first pattern (with length 0).
+constexpr uint8_t pattern_of(const char* const *patterns, uint8_t node, uint8_t index = 0){
+  return (node < pattern_offset(patterns, index + 1)) ? index : pattern_of(patterns, node, index + 1);
+}
+
+// Get the length of the prefix of a node at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (node) : the index of the node [uint8_t]
+//  @returns the length of the prefix [uint8_t]
+constexpr uint8_t pattern_depth(const char* const *patterns, uint8_t node){
+  return (node == 0) ? 0 : (node - pattern_offset(patterns, pattern_of(patterns, node)) + 1);
+}
+
+// Get the child of a node at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (count) : the number of patterns [uint8_t]
+//         (node) : the index of the node [uint8_t]
+//         (c) : the next character [char]
+//         (index) : the first pattern to check [uint8_t] (default: 0)
+//  @returns the index of the child, or PATTERN_NONE [uint8_t]
+constexpr uint8_t pattern_child(const char* const *patterns, uint8_t count, uint8_t node, char c, uint8_t index = 0){
+  return (index >= count) ? PATTERN_NONE :
+    (((pattern_length(patterns[index]) > pattern_depth(patterns, node)) &&
+      (patterns[index][pattern_depth(patterns, node)] == c) &&
+      pattern_same(patterns[index], patterns[pattern_of(patterns, node)], pattern_depth(patterns, node))) ?
+        pattern_node(patterns, index, pattern_depth(patterns, node) + 1) :
+        pattern_child(patterns, count, node, c, index + 1));
+}
+
+constexpr uint8_t pattern_fail(const char* const *, uint8_t, uint8_t);
+
+// Get the next node of the automaton at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (count) : the number of patterns [uint8_t]
+//         (node) : the index of the current node [uint8_t]
+//         (c) : the next character [char]
+//  @returns the index of the next node [uint8_t]
+constexpr uint8_t pattern_next(const char* const *patterns, uint8_t count, uint8_t node, char c){
+  return (pattern_child(patterns, count, node, c) != PATTERN_NONE) ? pattern_child(patterns, count, node, c) :
+    ((node == 0) ? 0 : pattern_next(patterns, count, pattern_fail(patterns, count, node), c));
+}
+
+// Get the failure node of a node at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (count) : the number of patterns [uint8_t]
+//         (node) : the index of the node [uint8_t]
+//  @returns the index of the node of the longest proper suffix [uint8_t]
+constexpr uint8_t pattern_fail(const char* const *patterns, uint8_t count, uint8_t node){
+  return (pattern_depth(patterns, node) <= 1) ? 0 :
+    pattern_next(patterns, count,
+      pattern_fail(patterns, count, pattern_node(patterns, pattern_of(patterns, node), pattern_depth(patterns, node) - 1)),
+      patterns[pattern_of(patterns, node)][pattern_depth(patterns, node) - 1]);
+}
+
+// Get the pattern that ends at a node at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (count) : the number of patterns [uint8_t]
+//         (node) : the index of the node [uint8_t]
+//         (index) : the first pattern to check [uint8_t] (default: 0)
+//  @returns the index of the pattern, or PATTERN_NONE [uint8_t]
+//  NOTE: if no pattern ends exactly at the node, the pattern of the failure
+//        node is used (a pattern that is a suffix of the prefix).
+constexpr uint8_t pattern_match(const char* const *patterns, uint8_t count, uint8_t node, uint8_t index = 0){
+  return (node == 0) ? PATTERN_NONE :
+    ((index >= count) ? pattern_match(patterns, count, pattern_fail(patterns, count, node)) :
+      (((pattern_length(patterns[index]) == pattern_depth(patterns, node)) &&
+        (pattern_node(patterns, index, pattern_length(patterns[index])) == node)) ?
+          index : pattern_match(patterns, count, node, index + 1)));
+}
+
+// Get the character of a node at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (node) : the index of the node [uint8_t] (not the root)
+//  @returns the last character of the prefix [char]
+constexpr char pattern_character(const char* const *patterns, uint8_t node){
+  return patterns[pattern_of(patterns, node)][pattern_depth(patterns, node) - 1];
+}
+
+// Check if the character of a node is new in the alphabet at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (node) : the index of the node [uint8_t] (not the root)
+//         (other) : the first node to compare [uint8_t] (default: 1)
+//  @returns true if no previous node has the same character [bool]
+constexpr bool pattern_new_character(const char* const *patterns, uint8_t node, uint8_t other = 1){
+  return (other >= node) ||
+    ((pattern_character(patterns, other) != pattern_character(patterns, node)) &&
+      pattern_new_character(patterns, node, other + 1));
+}
+
+// Get the size of the alphabet at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (size) : the number of nodes [uint8_t]
+//         (node) : the first node to check [uint8_t] (default: 1)
+//  @returns the number of distinct characters [uint8_t]
+constexpr uint8_t pattern_alphabet_size(const char* const *patterns, uint8_t size, uint8_t node = 1){
+  return (node >= size) ? 0 :
+    ((pattern_new_character(patterns, node) ? 1 : 0) + pattern_alphabet_size(patterns, size, node + 1));
+}
+
+// Get a character of the alphabet at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (index) : the index of the character in the alphabet [uint8_t]
+//         (node) : the first node to check [uint8_t] (default: 1)
+//  @returns the character [char]
+constexpr char pattern_alphabet(const char* const *patterns, uint8_t index, uint8_t node = 1){
+  return pattern_new_character(patterns, node) ?
+    ((index == 0) ? pattern_character(patterns, node) : pattern_alphabet(patterns, index - 1, node + 1)) :
+    pattern_alphabet(patterns, index, node + 1);
+}
+
+// Build a node of the automaton at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (count) : the number of patterns [uint8_t]
+//         (node) : the index of the node [uint8_t]
+//  @returns the node [PatternNode]
+constexpr PatternNode pattern_make_node(const char* const *patterns, uint8_t count, uint8_t node){
+  return ((node == 0) ||
+    (pattern_node(patterns, pattern_of(patterns, node), pattern_depth(patterns, node)) != node)) ?
+      PatternNode{ '\0' , PATTERN_NONE , 0 , PATTERN_NONE } : // root or unused
+      PatternNode{ patterns[pattern_of(patterns, node)][pattern_depth(patterns, node) - 1] ,
+        pattern_node(patterns, pattern_of(patterns, node), pattern_depth(patterns, node) - 1) ,
+        pattern_fail(patterns, count, node) ,
+        pattern_match(patterns, count, node) };
+}
+
+// The indices of the entries of an automaton (there is no <std::index_sequence> in C++11)
+template <uint16_t... I>
+struct PatternIndices {};
+
+template <uint16_t N, uint16_t... I>
+struct MakePatternIndices : MakePatternIndices<N - 1, N - 1, I...> {};
+
+template <uint16_t... I>
+struct MakePatternIndices<0, I...> {
+  typedef PatternIndices<I...> type;
+};
+
+// Build an automaton at compile time
+//  @param (patterns) : the list of patterns [char **]
+//         (count) : the number of patterns [uint8_t]
+//  @returns the automaton [PatternTable]
+//  NOTE: the indices are the nodes (I), the characters of the alphabet (K)
+//        and the transitions (T, node * A + character).
+template <uint8_t A, uint16_t... I, uint16_t... K, uint16_t... T>
+constexpr PatternTable<sizeof...(I), A> make_pattern_table(const char* const *patterns, uint8_t count,
+    PatternIndices<I...>, PatternIndices<K...>, PatternIndices<T...>){
+  return {
+    { pattern_make_node(patterns, count, I)... },
+    { pattern_alphabet(patterns, K)... },
+    { pattern_next(patterns, count, T / A, pattern_alphabet(patterns, T % A))... }
+  };
+}
+
+#define PATTERN_COUNT(patterns) (sizeof(patterns) / sizeof(patterns[0]))
+
+#define PATTERN_NODES(patterns) pattern_offset(patterns, PATTERN_COUNT(patterns))
+
+#define PATTERN_ALPHABET(patterns) pattern_alphabet_size(patterns, PATTERN_NODES(patterns))
+
+#define PATTERN_TABLE(patterns) \
+  make_pattern_table<PATTERN_ALPHABET(patterns)>(patterns, PATTERN_COUNT(patterns), \
+    typename MakePatternIndices<PATTERN_NODES(patterns)>::type(), \
+    typename MakePatternIndices<PATTERN_ALPHABET(patterns)>::type(), \
+    typename MakePatternIndices<PATTERN_NODES(patterns) * PATTERN_ALPHABET(patterns)>::type())
+
+// -----------------------------------------------------------------
+
+class PatternMatcher {
+  public:
+    PatternMatcher();
+    template <uint8_t N, uint8_t A>
+    void load(const PatternTable<N, A> &);
+    uint8_t match(uint8_t);
+    uint8_t position(void);
+    void reset(void);
+
+  private:
+    const PatternNode *_nodes;
+    const char *_alphabet;
+    const uint8_t *_next;
+    uint8_t _width;
+    uint8_t _node;
+    uint8_t _position;
+};
+
+// --------------------------------------------------
+
+// Load an automaton
+//  @param (table) : the nodes of the automaton [PatternTable]
+//  NOTE: the matcher is also reset.
+template <uint8_t N, uint8_t A>
+void PatternMatcher::load(const PatternTable<N, A> &table){
+  _nodes = table.nodes;
+  _alphabet = table.alphabet;
+  _next = table.next;
+  _width = A;
+  reset();
+}
+
+// -----------------------------------------------------------------
+
+#endif // PATTERN_MATCHER_H
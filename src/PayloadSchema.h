@@ -0,0 +1,347 @@
+#ifndef PAYLOAD_SCHEMA_H
+#define PAYLOAD_SCHEMA_H
+
+/*******************************************************************************
+* RoboCore Payload Schema Library (v1.0)
+*
+* Library to pack readings in the minimum number of bits, as described by a
+* schema declared at compile time.
+*
+* Copyright 2022 RoboCore.
+*
+*
+* This file is part of the SMW_SX1262M0 library ("SMW_SX1262M0-lib").
+*
+* "SMW_SX1262M0-lib" is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* "SMW_SX1262M0-lib" is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with "SMW_SX1262M0-lib". If not, see <https://www.gnu.org/licenses/>
+*******************************************************************************/
+
+// --------------------------------------------------
+// Dependencies
+
+extern "C" {
+  #include <stddef.h>
+  #include <stdint.h>
+  #include <string.h>
+}
+
+// -----------------------------------------------------------------
+
+// A field of a schema
+//  NOTE: the value is sent as the number of steps of <resolution> above
+//        <minimum>, using just enough bits for the range (up to 24 bits to
+//        keep the precision of <float>).
+struct PayloadField {
+  const char *name; // the name of the field (for the decoder of the server)
+  float minimum; // the lowest value
+  float resolution; // the size of a step
+  uint32_t steps; // the number of steps of the range
+  uint8_t bits; // the number of bits of the field
+};
+
+// -----------------------------------------------------------------
+
+// Get the number of steps of a range at compile time
+//  @param (minimum) : the lowest value [float]
+//         (maximum) : the highest value [float]
+//         (resolution) : the size of a step [float]
+//  @returns the number of steps [uint32_t]
+constexpr uint32_t payload_steps(float minimum, float maximum, float resolution){
+  return static_cast<uint32_t>((maximum - minimum) / resolution + 0.5f);
+}
+
+// Get the number of bits to store a number of steps at compile time
+//  @param (steps) : the number of steps [uint32_t]
+//  @returns the number of bits [uint8_t]
+constexpr uint8_t payload_width(uint32_t steps){
+  return (steps == 0) ? 0 : (1 + payload_width(steps >> 1));
+}
+
+// Get the number of bits of the first fields of a schema at compile time
+//  @param (fields) : the fields of the schema [PayloadField *]
+//         (count) : the number of fields [uint8_t]
+//  @returns the number of bits [uint16_t]
+constexpr uint16_t payload_bits(const PayloadField *fields, uint8_t count){
+  return (count == 0) ? 0 : (fields[count - 1].bits + payload_bits(fields, count - 1));
+}
+
+#define PAYLOAD_FIELD(name, minimum, maximum, resolution) \
+  PayloadField{ name , minimum , resolution , payload_steps(minimum, maximum, resolution) , \
+    payload_width(payload_steps(minimum, maximum, resolution)) }
+
+#define PAYLOAD_COUNT(schema) (sizeof(schema) / sizeof(schema[0]))
+
+#define PAYLOAD_SIZE(schema) ((payload_bits(schema, PAYLOAD_COUNT(schema)) + 7) / 8)
+
+// -----------------------------------------------------------------
+
+// Write bits to an array (MSB first)
+//  @param (data) : the array [uint8_t *]
+//         (offset) : the position of the first bit [uint16_t]
+//         (bits) : the number of bits [uint8_t]
+//         (value) : the value to write [uint32_t]
+inline void payload_write(uint8_t *data, uint16_t offset, uint8_t bits, uint32_t value){
+  while(bits > 0){
+    uint8_t shift = offset & 0x07;
+    uint8_t count = 8 - shift; // free bits of the byte
+    if(count > bits){
+      count = bits;
+    }
+    bits -= count;
+    uint8_t position = 8 - shift - count;
+    uint8_t mask = ((1 << count) - 1) << position;
+    uint8_t chunk = (value >> bits) << position;
+    data[offset >> 3] = (data[offset >> 3] & ~mask) | (chunk & mask);
+    offset += count;
+  }
+}
+
+// Read bits from an array (MSB first)
+//  @param (data) : the array [uint8_t *]
+//         (offset) : the position of the first bit [uint16_t]
+//         (bits) : the number of bits [uint8_t]
+//  @returns the value [uint32_t]
+inline uint32_t payload_read(const uint8_t *data, uint16_t offset, uint8_t bits){
+  uint32_t value = 0;
+  while(bits > 0){
+    uint8_t shift = offset & 0x07;
+    uint8_t count = 8 - shift; // remaining bits of the byte
+    if(count > bits){
+      count = bits;
+    }
+    bits -= count;
+    uint8_t chunk = (data[offset >> 3] >> (8 - shift - count)) & ((1 << count) - 1);
+    value = (value << count) | chunk;
+    offset += count;
+  }
+  return value;
+}
+
+// -----------------------------------------------------------------
+
+// The encoder of a payload
+//  NOTE: use PAYLOAD_SIZE(schema) for the template parameter.
+template <size_t SIZE>
+class PayloadEncoder {
+  public:
+    template <uint8_t N>
+    PayloadEncoder(const PayloadField (&)[N]);
+    const uint8_t* data(void) const;
+    void reset(void);
+    bool set(uint8_t, float);
+    bool set_raw(uint8_t, uint32_t);
+    size_t size(void) const;
+
+  private:
+    const PayloadField *_fields;
+    uint8_t _count;
+    uint8_t _data[SIZE];
+};
+
+// --------------------------------------------------
+
+// The decoder of a payload
+//  NOTE: the data is not copied, so it must be valid while decoding.
+class PayloadDecoder {
+  public:
+    template <uint8_t N>
+    PayloadDecoder(const PayloadField (&)[N], const uint8_t *, size_t);
+    float get(uint8_t) const;
+    uint32_t get_raw(uint8_t) const;
+    bool valid(void) const;
+
+  private:
+    const PayloadField *_fields;
+    uint8_t _count;
+    const uint8_t *_data;
+    size_t _length;
+
+    uint16_t _offset(uint8_t) const;
+};
+
+// -----------------------------------------------------------------
+
+// Constructor
+//  @param (fields) : the fields of the schema [PayloadField[]]
+template <size_t SIZE>
+template <uint8_t N>
+PayloadEncoder<SIZE>::PayloadEncoder(const PayloadField (&fields)[N]) :
+  _fields(fields),
+  _count(N)
+  {
+  reset();
+}
+
+// --------------------------------------------------
+
+// Get the packed data
+//  @returns the bytes to send [uint8_t *]
+template <size_t SIZE>
+const uint8_t* PayloadEncoder<SIZE>::data(void) const {
+  return _data;
+}
+
+// --------------------------------------------------
+
+// Reset the fields (to their minimum)
+template <size_t SIZE>
+void PayloadEncoder<SIZE>::reset(void){
+  memset(_data, 0, SIZE);
+}
+
+// --------------------------------------------------
+
+// Set the value of a field
+//  @param (index) : the index of the field in the schema [uint8_t]
+//         (value) : the value [float]
+//  @returns false if the index is invalid or if the value was out of range [bool]
+//  NOTE: a value out of range is limited to the range of the field.
+template <size_t SIZE>
+bool PayloadEncoder<SIZE>::set(uint8_t index, float value){
+  if(index >= _count){
+    return false;
+  }
+
+  const PayloadField &field = _fields[index];
+  float steps = (value - field.minimum) / field.resolution + 0.5f;
+  if(steps < 0){
+    set_raw(index, 0);
+    return false;
+  } else if(steps >= (field.steps + 1)){
+    set_raw(index, field.steps);
+    return false;
+  }
+  return set_raw(index, static_cast<uint32_t>(steps));
+}
+
+// --------------------------------------------------
+
+// Set the number of steps of a field
+//  @param (index) : the index of the field in the schema [uint8_t]
+//         (raw) : the number of steps above the minimum [uint32_t]
+//  @returns false if the index or the number of steps is invalid [bool]
+template <size_t SIZE>
+bool PayloadEncoder<SIZE>::set_raw(uint8_t index, uint32_t raw){
+  if((index >= _count) || (raw > _fields[index].steps)){
+    return false;
+  }
+
+  uint16_t offset = payload_bits(_fields, index);
+  if((offset + _fields[index].bits) > (SIZE * 8)){
+    return false; // invalid size
+  }
+  payload_write(_data, offset, _fields[index].bits, raw);
+  return true;
+}
+
+// --------------------------------------------------
+
+// Get the size of the packed data
+//  @returns the number of bytes to send [size_t]
+template <size_t SIZE>
+size_t PayloadEncoder<SIZE>::size(void) const {
+  return SIZE;
+}
+
+// -----------------------------------------------------------------
+
+// Constructor
+//  @param (fields) : the fields of the schema [PayloadField[]]
+//         (data) : the received bytes [uint8_t *]
+//         (length) : the number of bytes [size_t]
+template <uint8_t N>
+PayloadDecoder::PayloadDecoder(const PayloadField (&fields)[N], const uint8_t *data, size_t length) :
+  _fields(fields),
+  _count(N),
+  _data(data),
+  _length(length)
+  {
+}
+
+// --------------------------------------------------
+
+// Get the value of a field
+//  @param (index) : the index of the field in the schema [uint8_t]
+//  @returns the value, or 0 if the field is invalid [float]
+inline float PayloadDecoder::get(uint8_t index) const {
+  if((index >= _count) || ((_offset(index) + _fields[index].bits) > (_length * 8))){
+    return 0;
+  }
+  return _fields[index].minimum + (get_raw(index) * _fields[index].resolution);
+}
+
+// --------------------------------------------------
+
+// Get the number of steps of a field
+//  @param (index) : the index of the field in the schema [uint8_t]
+//  @returns the number of steps above the minimum, or 0 if the field is invalid [uint32_t]
+inline uint32_t PayloadDecoder::get_raw(uint8_t index) const {
+  if(index >= _count){
+    return 0;
+  }
+  uint16_t offset = _offset(index);
+  if((offset + _fields[index].bits) > (_length * 8)){
+    return 0; // truncated data
+  }
+  return payload_read(_data, offset, _fields[index].bits);
+}
+
+// --------------------------------------------------
+
+// Check if the data has the size of the schema
+//  @returns true if all the fields are available [bool]
+inline bool PayloadDecoder::valid(void) const {
+  return (_data != nullptr) && (_length == static_cast<size_t>((payload_bits(_fields, _count) + 7) / 8));
+}
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+// Get the position of a field
+//  @param (index) : the index of the field in the schema [uint8_t]
+//  @returns the position of the first bit [uint16_t]
+inline uint16_t PayloadDecoder::_offset(uint8_t index) const {
+  return payload_bits(_fields, index);
+}
+
+// -----------------------------------------------------------------
+
+// Print the decoder of the schema for the server (JavaScript)
+//  @param (output) : the destination [Print]
+//         (fields) : the fields of the schema [PayloadField[]]
+//  NOTE: the function <decodeUplink()> is compatible with The Things Stack
+//        and ChirpStack, so the server uses the same schema as the device.
+template <class P, uint8_t N>
+void payload_print_decoder(P &output, const PayloadField (&fields)[N]){
+  output.print("function decodeUplink(input) {\n");
+  output.print("  var b = input.bytes, o = 0;\n");
+  output.print("  function f(n) { var v = 0; for (var i = 0; i < n; i++, o++) { v = v * 2 + ((b[o >> 3] >> (7 - (o & 7))) & 1); } return v; }\n");
+  output.print("  var data = {};\n");
+  for(uint8_t i=0 ; i < N ; i++){
+    output.print("  data.");
+    output.print(fields[i].name);
+    output.print(" = ");
+    output.print(fields[i].minimum, 6);
+    output.print(" + f(");
+    output.print(fields[i].bits);
+    output.print(") * ");
+    output.print(fields[i].resolution, 6);
+    output.print(";\n");
+  }
+  output.print("  return { data: data };\n");
+  output.print("}\n");
+}
+
+// -----------------------------------------------------------------
+
+#endif // PAYLOAD_SCHEMA_H
@@ -32,1580 +32,3759 @@ extern "C" {
   #include <string.h>
 }
 
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#define SMW_SX1262M0_PROGMEM PROGMEM // (the constant tables are stored in the flash)
+#else
+#define SMW_SX1262M0_PROGMEM
+#endif
+
 // --------------------------------------------------
+// Program memory
+
+// Read a value of a constant table
+//  @param (value) : the value in the table [T]
+//  @returns the copy of the value [T]
+//  NOTE: on AVR, the tables are in the flash (SMW_SX1262M0_PROGMEM), so they
+//        don't use the RAM.
+template <typename T>
+static inline T progmem_read(const T &value){
+#if defined(__AVR__)
+  T copy;
+  memcpy_P(&copy, &value, sizeof(T));
+  return copy;
+#else
+  return value;
+#endif
+}
+
 // --------------------------------------------------
+// Status codes
 
-// Default constructor
-//  @param (stream) : the stream to send the data to [Stream *]
-SMW_SX1262M0::SMW_SX1262M0(Stream &stream) :
-  _stream(&stream),
-  _buffer(SMW_SX1262M0_BUFFER_SIZE)
-  {
-#ifdef SMW_SX1262M0_DEBUG
-    _stream_debug = nullptr;
-#endif
+// Get the length of a string at compile time
+//  @param (str) : the string [char *]
+//  @returns the length of the string [uint8_t]
+static constexpr uint8_t cstrlen(const char *str){
+  return (*str == CHAR_EOS) ? 0 : (1 + cstrlen(str + 1));
+}
+
+// Get the length of the common prefix of two strings at compile time
+//  @param (str1) : the first string [char *]
+//         (str2) : the second string [char *]
+//  @returns the length of the common prefix [uint8_t]
+static constexpr uint8_t cstrprefix(const char *str1, const char *str2){
+  return ((*str1 == CHAR_EOS) || (*str1 != *str2)) ? 0 : (1 + cstrprefix(str1 + 1, str2 + 1));
+}
+
+// Compare two strings at compile time
+//  @param (str1) : the first string [char *]
+//         (str2) : the second string [char *]
+//  @returns true if <str1> comes before <str2> [bool]
+static constexpr bool cstrless(const char *str1, const char *str2){
+  return (*str2 == CHAR_EOS) ? false :
+    ((*str1 == *str2) ? cstrless(str1 + 1, str2 + 1) : (*str1 < *str2));
+}
+
+// The status code of a response
+//  NOTE: the table is a trie flattened in lexicographic order: the codes that share a
+//        prefix are contiguous and <prefix> is the length of the prefix shared with the
+//        previous code in the table.
+struct StatusCode {
+  const char *text;
+  uint8_t length;
+  uint8_t prefix;
+  CommandResponse response;
+};
+
+// Build a status code at compile time
+//  @param (text) : the text of the status line [char *]
+//         (previous) : the text of the previous code in the table [char *]
+//         (response) : the type of the response [CommandResponse]
+//  @returns the status code [StatusCode]
+static constexpr StatusCode status_code(const char *text, const char *previous, CommandResponse response){
+  return { text , cstrlen(text) , cstrprefix(text, previous) , response };
+}
+
+static constexpr StatusCode STATUS_CODES[] SMW_SX1262M0_PROGMEM = {
+  status_code(RSPNS_ERROR_BUSY, "", CommandResponse::BUSY),
+  status_code(RSPNS_ERROR, RSPNS_ERROR_BUSY, CommandResponse::ERROR),
+  status_code(RSPNS_NO_NETWORK, RSPNS_ERROR, CommandResponse::NO_NETWORK),
+  status_code(RSPNS_ERROR_PARAMETER, RSPNS_NO_NETWORK, CommandResponse::PARAM_ERROR),
+  status_code(RSPNS_ERROR_PARAMETER_OVERFLOW, RSPNS_ERROR_PARAMETER, CommandResponse::PARAM_OVERFLOW),
+  status_code(RSPNS_OK, RSPNS_ERROR_PARAMETER_OVERFLOW, CommandResponse::OK)
+};
+
+static constexpr uint8_t STATUS_CODES_QTY = sizeof(STATUS_CODES) / sizeof(StatusCode);
+
+// Check the order of the status codes at compile time
+//  @param (index) : the index to start checking from [uint8_t]
+//  @returns true if the codes are in lexicographic order [bool]
+static constexpr bool status_codes_sorted(uint8_t index = 1){
+  return (index >= STATUS_CODES_QTY) ? true :
+    (cstrless(STATUS_CODES[index - 1].text, STATUS_CODES[index].text) && status_codes_sorted(index + 1));
 }
 
+static_assert(status_codes_sorted(), "the status codes must be in lexicographic order");
+
 // --------------------------------------------------
+// Unsolicited result codes
+
+// The prefix of an unsolicited result code
+struct URCCode {
+  const char *text;
+  uint8_t length;
+  URCType type;
+};
+
+static constexpr URCCode URC_CODES[] SMW_SX1262M0_PROGMEM = {
+  { URC_BOOT , cstrlen(URC_BOOT) , URCType::BOOT },
+  { URC_JOINED , cstrlen(URC_JOINED) , URCType::JOINED },
+  { URC_RECEIVED , cstrlen(URC_RECEIVED) , URCType::RECEIVED }
+};
+
+static constexpr uint8_t URC_CODES_QTY = sizeof(URC_CODES) / sizeof(URCCode);
+
 // --------------------------------------------------
+// Command frames
+
+static constexpr const char* FRAME_PREFIX = "AT+";
+static constexpr const char* FRAME_GET = "=?";
+static constexpr const char* FRAME_RUN = "";
+
+// A complete command frame, generated at compile time
+//  NOTE: the data is not NULL terminated (the size of the frame is the length of the data).
+template <uint8_t N>
+struct CommandFrame {
+  char data[N];
+};
+
+// The indices of the characters of a frame (there is no <std::index_sequence> in C++11)
+template <uint8_t... I>
+struct FrameIndices {};
+
+template <uint8_t N, uint8_t... I>
+struct MakeFrameIndices : MakeFrameIndices<N - 1, N - 1, I...> {};
+
+template <uint8_t... I>
+struct MakeFrameIndices<0, I...> {
+  typedef FrameIndices<I...> type;
+};
+
+// Get the length of a frame at compile time
+//  @param (str1) : the first part of the frame [char *]
+//         (str2) : the second part of the frame [char *]
+//         (str3) : the third part of the frame [char *]
+//  @returns the length of the frame, including the <CR> [uint8_t]
+static constexpr uint8_t frame_length(const char *str1, const char *str2, const char *str3){
+  return cstrlen(str1) + cstrlen(str2) + cstrlen(str3) + 1;
+}
 
-// Flush the buffered data in the stream
-void SMW_SX1262M0::flush(void){
-  while(_stream->available()){
-    _stream->read();
-  }
+// Get a character of a frame at compile time
+//  @param (str1) : the first part of the frame [char *]
+//         (str2) : the second part of the frame [char *]
+//         (str3) : the third part of the frame [char *]
+//         (index) : the index of the character [uint8_t]
+//  @returns the character [char]
+static constexpr char frame_char(const char *str1, const char *str2, const char *str3, uint8_t index){
+  return (index < cstrlen(str1)) ? str1[index] :
+    (((*str2 != CHAR_EOS) || (*str3 != CHAR_EOS)) ? frame_char(str2, str3, "", index - cstrlen(str1)) : CHAR_CR);
 }
 
-// --------------------------------------------------
+// Build a frame at compile time
+//  @param (str1) : the first part of the frame [char *]
+//         (str2) : the second part of the frame [char *]
+//         (str3) : the third part of the frame [char *]
+//  @returns the frame [CommandFrame]
+template <uint8_t... I>
+static constexpr CommandFrame<sizeof...(I)> make_frame(const char *str1, const char *str2, const char *str3, FrameIndices<I...>){
+  return {{ frame_char(str1, str2, str3, I)... }};
+}
 
-// Get the Adaptive Data Rate
-//  @param (adr) : the variable to store the result [uint8_t (&)]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_ADR(uint8_t (&adr)){
-  // send the command and read the response
-  _send_command(CMD_ADR, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
-#endif
+#define COMMAND_FRAME(str1, str2, str3) \
+  make_frame(str1, str2, str3, typename MakeFrameIndices<frame_length(str1, str2, str3)>::type())
+
+static constexpr auto FRAME_PING SMW_SX1262M0_PROGMEM = COMMAND_FRAME(CMD_AT, "", "");
+static constexpr auto FRAME_RESET SMW_SX1262M0_PROGMEM = COMMAND_FRAME(CMD_RESET, "", "");
+static constexpr auto FRAME_JOIN SMW_SX1262M0_PROGMEM = COMMAND_FRAME(FRAME_PREFIX, CMD_JOIN, FRAME_RUN);
+static constexpr auto FRAME_LORA_OFF SMW_SX1262M0_PROGMEM = COMMAND_FRAME(FRAME_PREFIX, CMD_LORA_OFF, FRAME_RUN);
+static constexpr auto FRAME_SAVE SMW_SX1262M0_PROGMEM = COMMAND_FRAME(FRAME_PREFIX, CMD_SAVE, FRAME_RUN);
+static constexpr auto FRAME_GET_RECV SMW_SX1262M0_PROGMEM = COMMAND_FRAME(FRAME_PREFIX, CMD_RECV, FRAME_GET);
+static constexpr auto FRAME_GET_RECVB SMW_SX1262M0_PROGMEM = COMMAND_FRAME(FRAME_PREFIX, CMD_RECVB, FRAME_GET);
+static constexpr auto FRAME_GET_VERSION SMW_SX1262M0_PROGMEM = COMMAND_FRAME(FRAME_PREFIX, CMD_VERSION, FRAME_GET);
+
+// Convert an application port to a string
+//  @param (sport) : the array to store the string [char[4]]
+//         (port) : the application port [uint8_t]
+static void format_port(char (&sport)[4], uint8_t port){
+  // parse the port
+  uint8_t aport = port; // auxiliary variable for <port>
+  uint8_t temp[3];
+  temp[0] = aport / 100;
+  aport %= 100;
+  temp[1] = aport / 10;
+  temp[2] = aport % 10;
 
-  if(res == CommandResponse::OK){
-    if(_buffer.available()){
-      adr = _buffer.read() - '0';
+  // set the header (port)
+  uint8_t index = 0;
+  aport = 0; // reset
+  for(uint8_t i=0 ; i < 3 ; i++){
+    if((temp[i] > 0) || (aport > 0)){
+      sport[index++] = temp[i] + '0'; // convert to ASCII character
     }
+    aport += temp[i]; // update (simple)
   }
+  sport[index] = CHAR_EOS;
+}
 
-  return res;
+// --------------------------------------------------
+// Timeouts
+
+// The default timeout of each class, used until enough latencies are observed
+static constexpr uint32_t TIMEOUT_DEFAULTS[SMW_SX1262M0_TIMEOUT_CLASSES] SMW_SX1262M0_PROGMEM = {
+  SMW_SX1262M0_TIMEOUT_READ, // READ
+  SMW_SX1262M0_TIMEOUT_WRITE, // WRITE
+  SMW_SX1262M0_TIMEOUT_WRITE, // SAVE
+  SMW_SX1262M0_TIMEOUT_WRITE, // SEND
+  SMW_SX1262M0_TIMEOUT_RESET, // RESET
+  SMW_SX1262M0_TIMEOUT_RESET // MODE (the Join Mode resets the module, but without the banner)
+};
+
+// Get the upper bound of a bin of the latency histogram
+//  @param (bin) : the index of the bin [uint8_t]
+//  @returns the latency in [ms] [uint32_t]
+//  NOTE: the bins are half octaves (4, 6, 8, 12, 16, 24, ...).
+static constexpr uint32_t latency_bound(uint8_t bin){
+  return static_cast<uint32_t>(4 + 2 * (bin & 1)) << (bin >> 1);
 }
 
 // --------------------------------------------------
+// Patterns
 
-// Get the Automatic Join
-//  @param (ajoin) : the variable to store the result [uint8_t (&)]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_AJoin(uint8_t (&ajoin)){
-  // send the command and read the response
-  _send_command(CMD_AJOIN, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
-#endif
+// The boot message of the module
+static constexpr const char* const PATTERNS_BANNER[] = { "ATtention" };
+static constexpr auto TABLE_BANNER PATTERN_PROGMEM = PATTERN_TABLE(PATTERNS_BANNER);
 
-  if(res == CommandResponse::OK){
-    if(_buffer.available()){
-      ajoin = _buffer.read() - '0';
+// The end of the reset after setting the Join Mode
+static constexpr const char* const PATTERNS_MARKER[] = { "AppKey" , "AppSKey" };
+static constexpr auto TABLE_MARKER PATTERN_PROGMEM = PATTERN_TABLE(PATTERNS_MARKER);
+
+// The fields of the P2P communication (in the order of <P2PField>, without NOTHING)
+static constexpr const char* const PATTERNS_P2P[] = { "RSSI=" , "SNR=" , "-> " };
+static constexpr auto TABLE_P2P PATTERN_PROGMEM = PATTERN_TABLE(PATTERNS_P2P);
+
+// --------------------------------------------------
+// Parameters
+
+// The parameters of the configuration, in the order they are applied
+//  NOTE: the Join Mode is the first, because it resets the module.
+static const Param APPLY_ORDER[] SMW_SX1262M0_PROGMEM = { Param::NJM , Param::APPEUI , Param::APPKEY , Param::DADDR ,
+  Param::APPSKEY , Param::NWKSKEY , Param::ADR , Param::DR , Param::AJOIN , Param::CFM };
+
+// Get the bit of a parameter in a mask
+//  @param (param) : the parameter [Param]
+//  @returns the bit of the parameter [uint16_t]
+static inline uint16_t param_bit(Param param){
+  return (1 << static_cast<uint8_t>(param));
+}
+
+// The GET frame of a parameter, generated at compile time
+//  NOTE: the frame is a variable of each parameter (see PARAM_FRAME), because
+//        the static members of a template can't be placed in the flash.
+template <Param P>
+struct ParamFrame;
+
+#define PARAM_FRAME(P, name) \
+  static constexpr auto name SMW_SX1262M0_PROGMEM = COMMAND_FRAME(FRAME_PREFIX, ParamDescriptor<P>::command, FRAME_GET); \
+  template <> \
+  struct ParamFrame<P> { \
+    typedef decltype(name) type; \
+    static constexpr const type &frame = name; \
+  }; \
+  constexpr const ParamFrame<P>::type &ParamFrame<P>::frame
+
+PARAM_FRAME(Param::ADR, FRAME_GET_ADR);
+PARAM_FRAME(Param::AJOIN, FRAME_GET_AJOIN);
+PARAM_FRAME(Param::APPEUI, FRAME_GET_APPEUI);
+PARAM_FRAME(Param::APPKEY, FRAME_GET_APPKEY);
+PARAM_FRAME(Param::APPSKEY, FRAME_GET_APPSKEY);
+PARAM_FRAME(Param::CFM, FRAME_GET_CFM);
+PARAM_FRAME(Param::CFS, FRAME_GET_CFS);
+PARAM_FRAME(Param::DADDR, FRAME_GET_DADDR);
+PARAM_FRAME(Param::DEVEUI, FRAME_GET_DEVEUI);
+PARAM_FRAME(Param::DR, FRAME_GET_DR);
+PARAM_FRAME(Param::NJM, FRAME_GET_NJM);
+PARAM_FRAME(Param::NJS, FRAME_GET_NJS);
+PARAM_FRAME(Param::NWKSKEY, FRAME_GET_NWKSKEY);
+PARAM_FRAME(Param::RSSI, FRAME_GET_RSSI);
+PARAM_FRAME(Param::SNR, FRAME_GET_SNR);
+
+// The parser and formatter of the values of a policy
+//  NOTE: <parse()> reads the response in the buffer, <format()> writes the string
+//        of the SET command (at least <width * 3 / 2 + 1> characters) and <decode()>
+//        reads the value back from that string.
+template <ParamPolicy POLICY>
+struct ParamCodec;
+
+template <>
+struct ParamCodec<ParamPolicy::DIGIT> {
+  template <typename D>
+  static void parse(Buffer &buffer, uint8_t (&value)){
+    if(buffer.available()){
+      value = buffer.read() - '0';
     }
   }
 
-  return res;
-}
+  template <typename D>
+  static bool format(char *str, uint8_t value){
+    // check the value
+    if(value > D::maximum){
+      return false;
+    }
 
-// --------------------------------------------------
+    str[0] = value + '0'; // convert to ASCII character
+    str[1] = CHAR_EOS;
+    return true;
+  }
 
-// Get the Application EUI
-//  @param (appeui) : the array to store the result [char[n]]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_AppEUI(char (&appeui)[SMW_SX1262M0_SIZE_APPEUI]){
-  // send the command and read the response
-  _send_command(CMD_APPEUI, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
-#endif
+  template <typename D>
+  static void decode(const char *str, uint8_t (&value)){
+    value = str[0] - '0';
+  }
 
-  if(res == CommandResponse::OK){
-    uint8_t length = _buffer.available();
+  template <typename D>
+  static bool equal(const uint8_t (&value1), const uint8_t (&value2)){
+    return (value1 == value2);
+  }
+};
+
+template <>
+struct ParamCodec<ParamPolicy::BOOLEAN> : ParamCodec<ParamPolicy::DIGIT> {
+  template <typename D>
+  static bool format(char *str, uint8_t value){
+    str[0] = (value == 1) ? '1' : '0'; // force binary value
+    str[1] = CHAR_EOS;
+    return true;
+  }
+};
+
+template <>
+struct ParamCodec<ParamPolicy::HEXADECIMAL> {
+  template <typename D>
+  static void parse(Buffer &buffer, char *value){
+    // copy only the hexadecimal digits
+    buffer_size_t length = buffer.available();
+    uint8_t count = 0;
+    for(buffer_size_t i=0 ; (i < length) && (count < D::width) ; i++){
+      if(isxdigit(buffer[i])){
+        value[count++] = buffer[i];
+      }
+    }
+    if(count < D::width){
+      value[count] = CHAR_EOS;
+    }
+  }
+
+  template <typename D>
+  static bool format(char *str, const char *value){
+    // filter the data and format the string ("xx:xx:...:xx")
     uint8_t index = 0;
-    for(uint8_t i=0 ; i < SMW_SX1262M0_SIZE_APPEUI ; i++){
-      if(isxdigit(_buffer[index])){
-        appeui[i] = _buffer[index++];
-      } else {
-        index++; // go the next
-        i--; // repeat the loop with the same index
+    uint8_t count = 0;
+    while((*value != CHAR_EOS) && (count < D::width)){
+      if(isxdigit(*value)){
+        if((count > 0) && ((count % 2) == 0)){
+          str[index++] = CHAR_COLON; // insert the colon
+        }
+        str[index++] = *value;
+        count++;
       }
+      value++;
+    }
+    str[index] = CHAR_EOS;
+    return true;
+  }
 
-      // check for end of buffer
-      if(index >= length){
-        break;
+  template <typename D>
+  static void decode(const char *str, char *value){
+    // copy only the hexadecimal digits
+    uint8_t count = 0;
+    while((*str != CHAR_EOS) && (count < D::width)){
+      if(isxdigit(*str)){
+        value[count++] = *str;
       }
+      str++;
     }
-    if(length < SMW_SX1262M0_SIZE_APPEUI){
-      appeui[length] = CHAR_EOS;
+    if(count < D::width){
+      value[count] = CHAR_EOS;
     }
   }
 
-  return res;
-}
-
-// --------------------------------------------------
-
-// Get the Application Key
-//  @param (appkey) : the array to store the result [char[n]]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_AppKey(char (&appkey)[SMW_SX1262M0_SIZE_APPKEY]){
-  // send the command and read the response
-  _send_command(CMD_APPKEY, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
-#endif
-
-  if(res == CommandResponse::OK){
-    uint8_t length = _buffer.available();
-    uint8_t index = 0;
-    for(uint8_t i=0 ; i < SMW_SX1262M0_SIZE_APPKEY ; i++){
-      if(isxdigit(_buffer[index])){
-        appkey[i] = _buffer[index++];
-      } else {
-        index++; // go the next
-        i--; // repeat the loop with the same index
+  template <typename D>
+  static bool equal(const char *value1, const char *value2){
+    // compare the digits, ignoring the case
+    for(uint8_t i=0 ; i < D::width ; i++){
+      if(tolower(value1[i]) != tolower(value2[i])){
+        return false;
       }
+      if(value1[i] == CHAR_EOS){
+        break; // both values are shorter than the width
+      }
+    }
+    return true;
+  }
+};
 
-      // check for end of buffer
-      if(index >= length){
-        break;
+template <>
+struct ParamCodec<ParamPolicy::DECIMAL> {
+  template <typename D>
+  static void parse(Buffer &buffer, float (&value)){
+    char str[D::width + 1] = { '0' }; // default value is 0
+    uint8_t index = 0;
+    while(buffer.available()){
+      char c = buffer.read();
+      if((isdigit(c) || (c == '-')) && (index < D::width)){
+        str[index++] = c;
       }
     }
-    if(length < SMW_SX1262M0_SIZE_APPKEY){
-      appkey[length] = CHAR_EOS;
+    value = atof(str);
+  }
+};
+
+#ifdef SMW_SX1262M0_CACHE
+
+// The access to the shadow cache of a parameter
+//  NOTE: the volatile parameters are never stored (see the specialization below).
+template <Param P, bool CACHED = ParamDescriptor<P>::cached>
+struct ParamShadow {
+  typedef ParamDescriptor<P> Descriptor;
+  static constexpr uint16_t MASK = (1 << static_cast<uint8_t>(P));
+
+  // Read the cached value
+  //  @returns false if the value is not cached [bool]
+  static bool read(ParamCache &cache, typename Descriptor::type (&value)){
+    if(!(cache.valid & MASK)){
+      return false;
     }
+    memcpy(&value, &static_cast<ParamCacheEntry<P> &>(cache).value, sizeof(value));
+    return true;
   }
 
-  return res;
-}
+  // Store the value read from the module
+  static void write(ParamCache &cache, typename Descriptor::type (&value)){
+    memcpy(&static_cast<ParamCacheEntry<P> &>(cache).value, &value, sizeof(value));
+    cache.valid |= MASK;
+  }
 
-// --------------------------------------------------
+  // Store the value set in the module
+  static void store(ParamCache &cache, typename Descriptor::input input){
+    char str[(Descriptor::width * 3 / 2) + 1];
+    if(ParamCodec<Descriptor::policy>::template format<Descriptor>(str, input)){
+      ParamCodec<Descriptor::policy>::template decode<Descriptor>(str, static_cast<ParamCacheEntry<P> &>(cache).value);
+      cache.valid |= MASK;
+    }
+  }
+
+  // Invalidate the cached value
+  static void invalidate(ParamCache &cache){
+    cache.valid &= ~MASK;
+  }
+};
+
+template <Param P>
+struct ParamShadow<P, false> {
+  typedef ParamDescriptor<P> Descriptor;
+  static bool read(ParamCache &, typename Descriptor::type (&)){ return false; }
+  static void write(ParamCache &, typename Descriptor::type (&)){}
+  static void invalidate(ParamCache &){}
+};
 
-// Get the Application Session Key
-//  @param (appskey) : the array to store the result [char[n]]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_AppSKey(char (&appskey)[SMW_SX1262M0_SIZE_APPSKEY]){
-  // send the command and read the response
-  _send_command(CMD_APPSKEY, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
 #endif
 
-  if(res == CommandResponse::OK){
-    uint8_t length = _buffer.available();
-    uint8_t index = 0;
-    for(uint8_t i=0 ; i < SMW_SX1262M0_SIZE_APPSKEY ; i++){
-      if(isxdigit(_buffer[index])){
-        appskey[i] = _buffer[index++];
-      } else {
-        index++; // go the next
-        i--; // repeat the loop with the same index
-      }
+// --------------------------------------------------
+// --------------------------------------------------
 
-      // check for end of buffer
-      if(index >= length){
-        break;
-      }
-    }
-    if(length < SMW_SX1262M0_SIZE_APPSKEY){
-      appskey[length] = CHAR_EOS;
-    }
+// Default constructor
+//  @param (stream) : the stream to send the data to [Stream *]
+SMW_SX1262M0::SMW_SX1262M0(Stream &stream) :
+  _stream(&stream),
+  _buffer(),
+  _line_open(false),
+  _line_start(0),
+  _data_length(0),
+  _status_index(0),
+  _status_length(0),
+  _callback(nullptr),
+  _phase(Phase::NONE),
+  _response(CommandResponse::OK),
+  _start_time(0),
+  _stop_time(0),
+  _timeout_class(TimeoutClass::NONE),
+  _found(false),
+  _match_index(0),
+  _p2p_field(P2PField::NOTHING),
+  _p2p_value_index(0),
+  _p2p_rssi(0),
+  _p2p_snr(0),
+  _p2p_target(nullptr),
+  _queue_head(0),
+  _queue_count(0),
+  _queue_sent(0),
+  _queue_data_head(0),
+  _queue_data_tail(0),
+  _queue_data_count(0),
+  _frame_direct(true),
+  _frame_length(0),
+  _frame_overflow(false),
+  _urc_buffer(),
+  _writer(*this),
+  _urc_line_open(false),
+  _joined(false),
+  _rx_parsing(false),
+  _rx_valid(false),
+  _rx_port(0),
+  _rx_offset(0),
+  _scheduler(SMW_SX1262M0_DWELL_TIME, SMW_SX1262M0_DUTY_CYCLE, SMW_SX1262M0_AIRTIME_BUDGET,
+    SMW_SX1262M0_AIRTIME_WINDOW, SMW_SX1262M0_RX_WINDOWS),
+  _data_rate(SMW_SX1262M0_CONFIG_KEEP),
+  _apply_config(nullptr),
+  _apply_mask(0),
+  _apply_reading(false),
+  _apply_response(CommandResponse::OK),
+  _spool(nullptr),
+  _spool_time(0),
+  _spool_sending(false),
+  _spooled(false)
+  {
+  // reset the handlers
+  for(uint8_t i=0 ; i < SMW_SX1262M0_URC_TYPES ; i++){
+    _urc_handlers[i] = nullptr;
+  }
+  for(uint8_t i=0 ; i < SMW_SX1262M0_DOWNLINK_HANDLERS ; i++){
+    _downlink_handlers[i].port = 0;
+    _downlink_handlers[i].handler = nullptr;
   }
 
-  return res;
-}
+#ifdef SMW_SX1262M0_ADAPTIVE_TIMEOUT
+  // reset the latency histograms
+  memset(_latency, 0, sizeof(_latency));
+  _timeout_percentile = SMW_SX1262M0_TIMEOUT_PERCENTILE;
+  _timeout_margin = SMW_SX1262M0_TIMEOUT_MARGIN;
+#endif
 
-// --------------------------------------------------
+#ifdef SMW_SX1262M0_CONFIRM
+  _confirm_state = ConfirmState::IDLE;
+  _confirm_status = ConfirmStatus::NONE;
+  _confirm_ticket = 0;
+  _confirm_attempts = 0;
+  _confirm_time = 0;
+  _confirm_restore = false;
+  _confirm_mode = SMW_SX1262M0_CONFIG_KEEP;
+  _confirm_port = 0;
+  _confirm_length = 0;
+  _confirm_handler = nullptr;
+#endif
 
-// Get the buffered data
-//  @param (buffer) : the variable to store the result [Buffer(&)]
-void SMW_SX1262M0::get_buffer(Buffer (&buffer)){
-  buffer = _buffer;
+#ifdef SMW_SX1262M0_CACHE
+  _cache.valid = 0;
+  _cache_hits = 0;
+  _cache_misses = 0;
+#endif
+
+#ifdef SMW_SX1262M0_DEBUG
+    _stream_debug = nullptr;
+#endif
 }
 
+// --------------------------------------------------
 // --------------------------------------------------
 
-// Get the Device Address
-//  @param (devaddr) : the array to store the result [char[n]]
+// Apply a configuration to the module
+//  @param (config) : the desired configuration [SMW_SX1262M0_Config]
 //  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_DevAddr(char (&devaddr)[SMW_SX1262M0_SIZE_DEVADDR]){
-  // send the command and read the response
-  _send_command(CMD_DADDR, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
-#endif
+//  NOTE: the current values are read in a single batch (pipelined) and only
+//        the parameters that differ are sent, followed by a single save. The
+//        Join Mode is applied first, because it resets the module (the other
+//        parameters are read again after the reset).
+CommandResponse SMW_SX1262M0::apply(const SMW_SX1262M0_Config (&config)){
+  _wait(); // finish the pending commands
+  _apply_config = &config;
+  _apply_response = CommandResponse::OK;
+
+  // get the parameters to apply
+  uint16_t requested = 0;
+  const uint8_t values[] = { config.join_mode , config.adr , config.dr , config.ajoin , config.confirmed };
+  const Param params[] = { Param::NJM , Param::ADR , Param::DR , Param::AJOIN , Param::CFM };
+  for(uint8_t i=0 ; i < sizeof(params) ; i++){
+    if(values[i] != SMW_SX1262M0_CONFIG_KEEP){
+      requested |= param_bit(params[i]);
+    }
+  }
+  const char *keys[] = { config.appeui , config.appkey , config.devaddr , config.appskey , config.nwkskey };
+  const Param key_params[] = { Param::APPEUI , Param::APPKEY , Param::DADDR , Param::APPSKEY , Param::NWKSKEY };
+  for(uint8_t i=0 ; i < sizeof(key_params) ; i++){
+    if(keys[i]){
+      requested |= param_bit(key_params[i]);
+    }
+  }
 
-  if(res == CommandResponse::OK){
-    uint8_t length = _buffer.available();
-    uint8_t index = 0;
-    for(uint8_t i=0 ; i < SMW_SX1262M0_SIZE_DEVADDR ; i++){
-      if(isxdigit(_buffer[index])){
-        devaddr[i] = _buffer[index++];
-      } else {
-        index++; // go the next
-        i--; // repeat the loop with the same index
-      }
+  // read the current values
+  uint16_t differ = _apply_read(requested);
+  bool dirty = (differ != 0);
 
-      // check for end of buffer
-      if(index >= length){
-        break;
-      }
-    }
-    if(length < SMW_SX1262M0_SIZE_DEVADDR){
-      devaddr[length] = CHAR_EOS;
+  // apply the Join Mode first (the unsaved parameters are lost on reset)
+  if((_apply_response == CommandResponse::OK) && (differ & param_bit(Param::NJM))){
+    _apply_write(param_bit(Param::NJM));
+    _wait();
+    if(_apply_response == CommandResponse::OK){
+      differ = _apply_read(requested & ~param_bit(Param::NJM)); // read again after the reset
     }
   }
 
-  return res;
+  // apply the other parameters and save (only if necessary)
+  CommandResponse res = CommandResponse::OK;
+  if((_apply_response == CommandResponse::OK) && dirty){
+    _apply_write(differ & ~param_bit(Param::NJM));
+    res = begin_save() ? _wait() : CommandResponse::ERROR;
+  }
+
+  _apply_config = nullptr; // reset
+  return (_apply_response != CommandResponse::OK) ? _apply_response : res;
 }
 
 // --------------------------------------------------
 
-// Get the Device EUI
-//  @param (deveui) : the array to store the result [char[n]]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_DevEUI(char (&deveui)[SMW_SX1262M0_SIZE_DEVEUI]){
-  // send the command and read the response
-  _send_command(CMD_DEVEUI, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
+// Join the network (non blocking)
+//  @param (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+bool SMW_SX1262M0::begin_join(CommandCallback callback){
+  _joined = false; // reset
+#ifdef SMW_SX1262M0_CACHE
+  invalidate_cache(); // the session is renewed
 #endif
+  _queue_frame(FRAME_JOIN.data, sizeof(FRAME_JOIN));
+  return _queue_push(Phase::RESPONSE, TimeoutClass::READ, callback);
+}
 
-  if(res == CommandResponse::OK){
-    uint8_t length = _buffer.available();
-    uint8_t index = 0;
-    for(uint8_t i=0 ; i < SMW_SX1262M0_SIZE_DEVEUI ; i++){
-      if(isxdigit(_buffer[index])){
-        deveui[i] = _buffer[index++];
-      } else {
-        index++; // go the next
-        i--; // repeat the loop with the same index
-      }
+// --------------------------------------------------
 
-      // check for end of buffer
-      if(index >= length){
-        break;
-      }
-    }
-    if(length < SMW_SX1262M0_SIZE_DEVEUI){
-      deveui[length] = CHAR_EOS;
-    }
-  }
+// Listen for incoming data in the P2P communication (LoRa Test) (non blocking)
+//  @param (timeout) : the time to wait, in [ms] [uint32_t]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the listening was queued [bool]
+//  NOTE: call <poll()> to complete the command. The response is DATA when a message
+//        is received and OK on timeout.
+bool SMW_SX1262M0::begin_P2P_listen(uint32_t timeout, CommandCallback callback){
+  // assign default values
+  _p2p_rssi = 0;
+  _p2p_snr = 0;
 
-  return res;
+  _frame_begin(false); // nothing to send
+  return _queue_push(Phase::LISTEN, TimeoutClass::NONE, callback, true, timeout); // the output is not a response
 }
 
 // --------------------------------------------------
 
-// Get the Data Rate
-//  @param (dr) : the variable to store the result [uint8_t (&)]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_DR(uint8_t (&dr)){
-  // send the command and read the response
-  _send_command(CMD_DR, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
-#endif
+// Ping the module (non blocking)
+//  @param (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+bool SMW_SX1262M0::begin_ping(CommandCallback callback){
+  _queue_frame(FRAME_PING.data, sizeof(FRAME_PING));
+  return _queue_push(Phase::RESPONSE, TimeoutClass::READ, callback);
+}
 
-  if(res == CommandResponse::OK){
-    if(_buffer.available()){
-      dr = _buffer.read() - '0';
-    }
-  }
+// --------------------------------------------------
 
-  return res;
+// Read a text message from the module (non blocking)
+//  @param (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command. The data is passed to the callback
+//        and to the downlink handler of the port.
+bool SMW_SX1262M0::begin_readT(CommandCallback callback){
+  _queue_frame(FRAME_GET_RECV.data, sizeof(FRAME_GET_RECV));
+  return _queue_push(Phase::RECEIVE, TimeoutClass::READ, callback);
 }
 
 // --------------------------------------------------
 
-// Get the Join Mode
-//  @param (mode) : the variable to store the result [uint8_t (&)]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_JoinMode(uint8_t (&mode)){
-  // send the command and read the response
-  _send_command(CMD_NJM, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
+// Read an hexadecimal message from the module (non blocking)
+//  @param (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command. The data is passed to the callback
+//        and to the downlink handler of the port.
+bool SMW_SX1262M0::begin_readX(CommandCallback callback){
+  _queue_frame(FRAME_GET_RECVB.data, sizeof(FRAME_GET_RECVB));
+  return _queue_push(Phase::RECEIVE, TimeoutClass::READ, callback);
+}
+
+// --------------------------------------------------
+
+// Reset the module (non blocking)
+//  @param (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command. The command is completed as
+//        soon as the boot message is received.
+bool SMW_SX1262M0::begin_reset(CommandCallback callback){
+  _joined = false; // reset
+#ifdef SMW_SX1262M0_CACHE
+  invalidate_cache(); // the unsaved configuration is lost
 #endif
+  _queue_frame(FRAME_RESET.data, sizeof(FRAME_RESET)); // do a software reset
+  return _queue_push(Phase::BANNER, TimeoutClass::RESET, callback, true); // the module is reset
+}
 
-  if(res == CommandResponse::OK){
-    if(_buffer.available()){
-      mode = _buffer.read() - '0';
-    }
-  }
+// --------------------------------------------------
 
-  return res;
+// Save the current configuration (non blocking)
+//  @param (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+bool SMW_SX1262M0::begin_save(CommandCallback callback){
+  _queue_frame(FRAME_SAVE.data, sizeof(FRAME_SAVE));
+  return _queue_push(Phase::RESPONSE, TimeoutClass::SAVE, callback); // this command takes some time to reply
 }
 
 // --------------------------------------------------
 
-// Get the Join Status
-//  @param (status) : the variable to store the result [uint8_t (&)]
+// Start sending a message with a streaming payload
+//  @param (port) : the application port [uint8_t]
+//         (hex) : true to send the bytes as hexadecimal (binary message) [bool] (default: false)
+//  @returns the writer of the payload [SMW_SX1262M0_Writer (&)]
+//  NOTE: <print()> or <write()> the payload to the writer, then call <end_send()>.
+//        The payload is written directly to the module, so no other command
+//        can be sent until <end_send()>. If the uplink is not allowed yet (see
+//        <get_send_delay()>), the writer discards the data and <end_send()>
+//        returns the reason. The length of the payload is unknown in advance,
+//        so the dwell time is not checked.
+SMW_SX1262M0_Writer& SMW_SX1262M0::begin_send(uint8_t port, bool hex){
+  _begin_stream(hex ? CMD_SENDB : CMD_SEND, port, hex);
+  return _writer;
+}
+
+// --------------------------------------------------
+
+#ifdef SMW_SX1262M0_CONFIRM
+
+// Send a confirmed binary message (non blocking)
+//  @param (port) : the application port [uint8_t]
+//         (data) : the bytes to send [uint8_t *]
+//         (length) : the number of bytes [size_t]
+//  @returns the ticket of the message, or 0 if it can't be sent [uint8_t]
+//  NOTE: call <poll()> to send the message and to track its acknowledgement
+//        (see <get_confirm_status()>). The message is retransmitted (with
+//        backoff) until acknowledged or for SMW_SX1262M0_CONFIRM_ATTEMPTS
+//        times. The Confirm Mode is enabled only for this message (it is
+//        read before and restored after, if changed).
+//        A single confirmed message is tracked at a time.
+uint8_t SMW_SX1262M0::begin_send_confirmed(uint8_t port, const uint8_t *data, size_t length){
+  if((_confirm_state != ConfirmState::IDLE) || (length > SMW_SX1262M0_CONFIRM_SIZE)){
+    return 0;
+  }
+
+  // store the message
+  memcpy(_confirm_data, data, length);
+  _confirm_length = length;
+  _confirm_port = port;
+  _confirm_attempts = 0;
+  _confirm_time = millis();
+  _confirm_state = ConfirmState::SEND;
+  _confirm_status = ConfirmStatus::PENDING;
+
+  // get the next ticket
+  _confirm_ticket++;
+  if(_confirm_ticket == 0){
+    _confirm_ticket = 1; // skip the invalid ticket
+  }
+  return _confirm_ticket;
+}
+
+#endif
+
+// --------------------------------------------------
+
+// Send a text message (non blocking)
+//  @param (port) : the application port [uint8_t]
+//         (data) : the text data to send [char *]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+//        The uplink is not queued if it is not allowed yet (see <get_send_delay()>).
+bool SMW_SX1262M0::begin_sendT(uint8_t port, const char *data, CommandCallback callback){
+  return _begin_send(CMD_SEND, port, data, callback);
+}
+
+// --------------------------------------------------
+
+// Send an hexadecimal message (non blocking)
+//  @param (port) : the application port [uint8_t]
+//         (data) : the text data to send [char *]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+//        The uplink is not queued if it is not allowed yet (see <get_send_delay()>).
+bool SMW_SX1262M0::begin_sendX(uint8_t port, const char *data, CommandCallback callback){
+  return _begin_send(CMD_SENDB, port, data, callback);
+}
+
+// --------------------------------------------------
+
+// Send a binary message (non blocking)
+//  @param (port) : the application port [uint8_t]
+//         (data) : the bytes to send [uint8_t *]
+//         (length) : the number of bytes [size_t]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command. The data is encoded as
+//        hexadecimal directly in the frame (no intermediate string).
+//        The uplink is not queued if it is not allowed yet (see <get_send_delay()>).
+bool SMW_SX1262M0::begin_sendX(uint8_t port, const uint8_t *data, size_t length, CommandCallback callback){
+  if(_check_uplink(length) != CommandResponse::OK){
+    return false;
+  }
+
+  char sport[4]; // port stringified (0 to 999)
+  format_port(sport, port);
+
+  // build the command
+  char frame[SMW_SX1262M0_FRAME_SIZE];
+  uint8_t flength = 0;
+  const char separator[] = {CHAR_COLON, CHAR_EOS};
+  const char assignment[] = {CHAR_EQUAL, CHAR_EOS};
+  const char terminator[] = {CHAR_CR, CHAR_EOS};
+  _frame_begin();
+  flength = _frame_append(frame, flength, FRAME_PREFIX);
+  flength = _frame_append(frame, flength, CMD_SENDB);
+  flength = _frame_append(frame, flength, assignment);
+  flength = _frame_append(frame, flength, sport);
+  flength = _frame_append(frame, flength, separator);
+  flength = _frame_append(frame, flength, data, length);
+  flength = _frame_append(frame, flength, terminator);
+  _frame_write(frame, flength);
+  _frame_end();
+
+  return _push_uplink(length, callback); // this command takes some time to reply
+}
+
+// --------------------------------------------------
+
+// Set a parameter (non blocking)
+//  @param (value) : the value to be sent [input of the parameter]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+template <Param P>
+bool SMW_SX1262M0::begin_set(typename ParamDescriptor<P>::input value, CommandCallback callback){
+  typedef ParamDescriptor<P> Descriptor;
+
+  // format the value
+  char str[(Descriptor::width * 3 / 2) + 1];
+  if(!ParamCodec<Descriptor::policy>::template format<Descriptor>(str, value)){
+    return false;
+  }
+  
+#ifdef SMW_SX1262M0_CACHE
+  ParamShadow<P>::invalidate(_cache); // the value is stored on success (see <set()>)
+#endif
+  
+  // queue the command
+  _queue_command(Descriptor::command, CommandAction::SET, 1, str);
+  if(Descriptor::reset){
+    _joined = false; // reset (the module is reset)
+#ifdef SMW_SX1262M0_CACHE
+    invalidate_cache();
+#endif
+    return _queue_push(Phase::MARKER, Descriptor::timeout_set, callback, true); // wait for the reset of the module
+  }
+  return _queue_push(Phase::RESPONSE, Descriptor::timeout_set, callback);
+}
+
+// --------------------------------------------------
+
+// Set the Adaptive Data Rate (non blocking)
+//  @param (adr) : the data to be sent [uint8_t]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+bool SMW_SX1262M0::begin_set_ADR(uint8_t adr, CommandCallback callback){
+  return begin_set<Param::ADR>(adr, callback);
+}
+
+// --------------------------------------------------
+
+// Set the Automatic Join (non blocking)
+//  @param (ajoin) : the data to be sent [uint8_t]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+bool SMW_SX1262M0::begin_set_AJoin(uint8_t ajoin, CommandCallback callback){
+  return begin_set<Param::AJOIN>(ajoin, callback);
+}
+
+// --------------------------------------------------
+
+// Set the Application EUI (non blocking)
+//  @param (appeui) : the array with the data to be sent [char *]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+bool SMW_SX1262M0::begin_set_AppEUI(const char *appeui, CommandCallback callback){
+  return begin_set<Param::APPEUI>(appeui, callback);
+}
+
+// --------------------------------------------------
+
+// Set the Application Key (non blocking)
+//  @param (appkey) : the array with the data to be sent [char *]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+bool SMW_SX1262M0::begin_set_AppKey(const char *appkey, CommandCallback callback){
+  return begin_set<Param::APPKEY>(appkey, callback);
+}
+
+// --------------------------------------------------
+
+// Set the Application Session Key (non blocking)
+//  @param (appskey) : the array with the data to be sent [char *]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+bool SMW_SX1262M0::begin_set_AppSKey(const char *appskey, CommandCallback callback){
+  return begin_set<Param::APPSKEY>(appskey, callback);
+}
+
+// --------------------------------------------------
+
+// Set the Confirm Mode (non blocking)
+//  @param (confirmed) : the data to be sent [uint8_t]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+bool SMW_SX1262M0::begin_set_Confirmed(uint8_t confirmed, CommandCallback callback){
+  return begin_set<Param::CFM>(confirmed, callback);
+}
+
+// --------------------------------------------------
+
+// Set the Device Address (non blocking)
+//  @param (devaddr) : the array with the data to be sent [char *]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+bool SMW_SX1262M0::begin_set_DevAddr(const char *devaddr, CommandCallback callback){
+  return begin_set<Param::DADDR>(devaddr, callback);
+}
+
+// --------------------------------------------------
+
+// Set the Data Rate (non blocking)
+//  @param (dr) : the data to be sent [uint8_t]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+bool SMW_SX1262M0::begin_set_DR(uint8_t dr, CommandCallback callback){
+  return begin_set<Param::DR>(dr, callback);
+}
+
+// --------------------------------------------------
+
+// Set the Join Mode (non blocking)
+//  @param (mode) : the data to be sent [uint8_t]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command. The module is reset before the response.
+bool SMW_SX1262M0::begin_set_JoinMode(uint8_t mode, CommandCallback callback){
+  return begin_set<Param::NJM>(mode, callback);
+}
+
+// --------------------------------------------------
+
+// Set the Network Session Key (non blocking)
+//  @param (nwkskey) : the array with the data to be sent [char *]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: call <poll()> to complete the command.
+bool SMW_SX1262M0::begin_set_NwkSKey(const char *nwkskey, CommandCallback callback){
+  return begin_set<Param::NWKSKEY>(nwkskey, callback);
+}
+
+// --------------------------------------------------
+
+// Finish sending a message with a streaming payload
 //  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_JoinStatus(uint8_t (&status)){
+//  NOTE: must be preceded by <begin_send()>.
+CommandResponse SMW_SX1262M0::end_send(void){
+  if(!_writer._open){
+    CommandResponse res = _writer._refusal;
+    _writer._refusal = CommandResponse::ERROR; // reset
+    return res;
+  }
+  _writer._open = false; // reset
+
+  // end the frame
+  const char terminator[] = {CHAR_CR};
+  _frame_write(terminator, 1);
+  _frame_end();
+
+  // read the response
+  size_t length = _writer._hexadecimal ? (_writer._length / 2) : _writer._length;
+  if(!_push_uplink(length, nullptr)){
+    return CommandResponse::ERROR;
+  }
+  return _wait();
+}
+
+// --------------------------------------------------
+
+// Check if there are pending commands
+//  @returns true if a command is queued or waiting for its response [bool]
+bool SMW_SX1262M0::busy(void){
+  return (_queue_count > 0);
+}
+
+// --------------------------------------------------
+
+// Flush the buffered data in the stream
+//  NOTE: the data is not discarded, the lines are dispatched as unsolicited
+//        result codes (URC) to the handlers.
+void SMW_SX1262M0::flush(void){
+  while(_stream->available()){
+    _parse_URC(_stream->read());
+  }
+}
+
+// --------------------------------------------------
+
+// Get a parameter
+//  @param (value) : the variable to store the result [type of the parameter (&)]
+//  @returns the type of the response [CommandResponse]
+template <Param P>
+CommandResponse SMW_SX1262M0::get(typename ParamDescriptor<P>::type (&value)){
+  typedef ParamDescriptor<P> Descriptor;
+
+#ifdef SMW_SX1262M0_CACHE
+  // check the cache
+  if(ParamShadow<P>::read(_cache, value)){
+    _cache_hits++;
+    return CommandResponse::OK;
+  }
+  if(Descriptor::cached){
+    _cache_misses++;
+  }
+#endif
+
   // send the command and read the response
-  _send_command(CMD_NJS, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
+  _send_frame(ParamFrame<P>::frame.data, sizeof(ParamFrame<P>::frame));
+  CommandResponse res = _read_response(Descriptor::timeout_get);
   
 #ifdef SMW_SX1262M0_DEBUG
   _buffer.print(_stream_debug);
 #endif
 
   if(res == CommandResponse::OK){
-    if(_buffer.available()){
-      uint8_t b = _buffer.read();
-      status = b - '0';
+    ParamCodec<Descriptor::policy>::template parse<Descriptor>(_buffer, value);
+#ifdef SMW_SX1262M0_CACHE
+    ParamShadow<P>::write(_cache, value);
+#endif
+  }
+
+  return res;
+}
+
+// --------------------------------------------------
+
+// Get the Adaptive Data Rate
+//  @param (adr) : the variable to store the result [uint8_t (&)]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_ADR(uint8_t (&adr)){
+  return get<Param::ADR>(adr);
+}
+
+// --------------------------------------------------
+
+// Get the Automatic Join
+//  @param (ajoin) : the variable to store the result [uint8_t (&)]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_AJoin(uint8_t (&ajoin)){
+  return get<Param::AJOIN>(ajoin);
+}
+
+// --------------------------------------------------
+
+// Get the Application EUI
+//  @param (appeui) : the array to store the result [char[n]]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_AppEUI(char (&appeui)[SMW_SX1262M0_SIZE_APPEUI]){
+  return get<Param::APPEUI>(appeui);
+}
+
+// --------------------------------------------------
+
+// Get the Application Key
+//  @param (appkey) : the array to store the result [char[n]]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_AppKey(char (&appkey)[SMW_SX1262M0_SIZE_APPKEY]){
+  return get<Param::APPKEY>(appkey);
+}
+
+// --------------------------------------------------
+
+// Get the Application Session Key
+//  @param (appskey) : the array to store the result [char[n]]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_AppSKey(char (&appskey)[SMW_SX1262M0_SIZE_APPSKEY]){
+  return get<Param::APPSKEY>(appskey);
+}
+
+// --------------------------------------------------
+
+// Get the buffered data
+//  @param (buffer) : the variable to store the result [Buffer(&)]
+//  NOTE: the data is copied (see <take_buffer()>).
+void SMW_SX1262M0::get_buffer(Buffer (&buffer)){
+  buffer = _buffer;
+}
+
+// --------------------------------------------------
+
+#ifdef SMW_SX1262M0_CONFIRM
+
+// Get the status of a confirmed message
+//  @param (ticket) : the ticket of the message (see <begin_send_confirmed()>) [uint8_t]
+//  @returns the status of the message, or NONE if the ticket is unknown [ConfirmStatus]
+//  NOTE: only the status of the last message is stored.
+ConfirmStatus SMW_SX1262M0::get_confirm_status(uint8_t ticket){
+  if((ticket == 0) || (ticket != _confirm_ticket)){
+    return ConfirmStatus::NONE;
+  }
+  return _confirm_status;
+}
+
+#endif
+
+// --------------------------------------------------
+
+// Get the Confirm Mode
+//  @param (confirmed) : the variable to store the result [uint8_t (&)]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_Confirmed(uint8_t (&confirmed)){
+  return get<Param::CFM>(confirmed);
+}
+
+// --------------------------------------------------
+
+#ifdef SMW_SX1262M0_CACHE
+
+// Get the statistics of the shadow cache
+//  @param (hits) : the variable to store the number of reads from the cache [uint16_t (&)]
+//         (misses) : the variable to store the number of reads from the module [uint16_t (&)]
+//  NOTE: the volatile parameters (join status, RSSI and SNR) are not counted.
+void SMW_SX1262M0::get_cache_stats(uint16_t (&hits), uint16_t (&misses)){
+  hits = _cache_hits;
+  misses = _cache_misses;
+}
+
+#endif
+
+// --------------------------------------------------
+
+// Get the Device Address
+//  @param (devaddr) : the array to store the result [char[n]]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_DevAddr(char (&devaddr)[SMW_SX1262M0_SIZE_DEVADDR]){
+  return get<Param::DADDR>(devaddr);
+}
+
+// --------------------------------------------------
+
+// Get the Device EUI
+//  @param (deveui) : the array to store the result [char[n]]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_DevEUI(char (&deveui)[SMW_SX1262M0_SIZE_DEVEUI]){
+  return get<Param::DEVEUI>(deveui);
+}
+
+// --------------------------------------------------
+
+// Get the Data Rate
+//  @param (dr) : the variable to store the result [uint8_t (&)]
+//  @returns the type of the response [CommandResponse]
+//  NOTE: the data rate is also used to calculate the time on air of the uplinks.
+CommandResponse SMW_SX1262M0::get_DR(uint8_t (&dr)){
+  CommandResponse res = get<Param::DR>(dr);
+  if(res == CommandResponse::OK){
+    _data_rate = dr; // update
+  }
+  return res;
+}
+
+// --------------------------------------------------
+
+// Get the Join Mode
+//  @param (mode) : the variable to store the result [uint8_t (&)]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_JoinMode(uint8_t (&mode)){
+  return get<Param::NJM>(mode);
+}
+
+// --------------------------------------------------
+
+// Get the Join Status
+//  @param (status) : the variable to store the result [uint8_t (&)]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_JoinStatus(uint8_t (&status)){
+  CommandResponse res = get<Param::NJS>(status);
+  if(res == CommandResponse::OK){
+    _joined = (status == SMW_SX1262M0_JOIN_STATUS_JOINED); // update
+  }
+
+  return res;
+}
+
+// --------------------------------------------------
+
+// Get the maximum payload of an uplink
+//  @returns the maximum length at the current data rate [bytes]
+//  NOTE: the data rate is the last one read or set (see <get_send_delay()>).
+//        If unknown, the lowest maximum of the region is used.
+uint8_t SMW_SX1262M0::get_max_payload(void){
+  if(_data_rate > AIRTIME_DR_MAX){
+    return (SMW_SX1262M0_DWELL_TIME > 0) ? airtime_max_payload(2, SMW_SX1262M0_DWELL_TIME) : airtime_max_length(0);
+  }
+  return airtime_max_payload(_data_rate, SMW_SX1262M0_DWELL_TIME);
+}
+
+// --------------------------------------------------
+
+// Get the Network Session Key
+//  @param (nwkskey) : the array to store the result [char[n]]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_NwkSKey(char (&nwkskey)[SMW_SX1262M0_SIZE_NWKSKEY]){
+  return get<Param::NWKSKEY>(nwkskey);
+}
+
+// --------------------------------------------------
+
+// Get the signal quality of the last P2P message
+//  @param (rssi) : the variable to store the RSSI [float (&)]
+//         (snr) : the variable to store the SNR [float (&)]
+void SMW_SX1262M0::get_P2P_signal(float (&rssi), float (&snr)){
+  rssi = _p2p_rssi;
+  snr = _p2p_snr;
+}
+
+// --------------------------------------------------
+
+// Get the response of the last completed command
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_response(void){
+  return _response;
+}
+
+// --------------------------------------------------
+
+// Get the RSSI of the last received data
+//  @param (rssi) : the variable to store the result [float (&)]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_RSSI(float (&rssi)){
+  return get<Param::RSSI>(rssi);
+}
+
+// --------------------------------------------------
+
+// Get the time to wait before an uplink
+//  @param (length) : the length of the payload [bytes]
+//  @returns the time to wait, or AIRTIME_NEVER if the uplink can't be sent [ms]
+//  NOTE: the time on air is calculated with the last data rate read or set
+//        with <get_DR()>, <set_DR()> or <apply()> (call <get_DR()> again if
+//        the ADR is enabled). Until then, only the receive windows of the
+//        last uplink are checked.
+uint32_t SMW_SX1262M0::get_send_delay(size_t length){
+  if(length > 0xFF){
+    return AIRTIME_NEVER;
+  }
+  return _scheduler.delay(millis(), _data_rate, length);
+}
+
+// --------------------------------------------------
+
+// Get the SNR of the last received data
+//  @param (snr) : the variable to store the result [float (&)]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::get_SNR(float (&snr)){
+  return get<Param::SNR>(snr);
+}
+
+// --------------------------------------------------
+
+// Get the timeout of a class of commands
+//  @param (type) : the class of the commands [TimeoutClass]
+//  @returns the timeout in [ms] [uint32_t]
+//  NOTE: the timeout is the percentile of the observed latencies plus the margin.
+//        The default value is used until enough latencies are observed, and
+//        twice the default value if the percentile is in the overflow bin.
+//        Only the default value is used without SMW_SX1262M0_ADAPTIVE_TIMEOUT.
+uint32_t SMW_SX1262M0::get_timeout(TimeoutClass type){
+  if(type == TimeoutClass::NONE){
+    return 0;
+  }
+  uint32_t fallback = progmem_read(TIMEOUT_DEFAULTS[static_cast<uint8_t>(type)]);
+#ifdef SMW_SX1262M0_ADAPTIVE_TIMEOUT
+  const uint8_t *bins = _latency[static_cast<uint8_t>(type)];
+
+  // count the samples
+  uint16_t total = 0;
+  for(uint8_t i=0 ; i < SMW_SX1262M0_LATENCY_BINS ; i++){
+    total += bins[i];
+  }
+  if(total < SMW_SX1262M0_LATENCY_SAMPLES){
+    return fallback; // cold start
+  }
+
+  // find the bin of the percentile
+  uint16_t rank = ((static_cast<uint32_t>(total) * _timeout_percentile) + 99) / 100; // round up
+  uint16_t count = 0;
+  for(uint8_t i=0 ; i < (SMW_SX1262M0_LATENCY_BINS - 1) ; i++){
+    count += bins[i];
+    if(count >= rank){
+      return latency_bound(i) + _timeout_margin;
+    }
+  }
+  return fallback * 2; // overflow
+#else
+  return fallback;
+#endif
+}
+
+// --------------------------------------------------
+
+// Get the Version
+//  @param (version) : the array to store the result [uint8_t[n]]
+//  @returns the type of the response [CommandResponse]
+//  NOTE: currently tested only with "v1.2 build 38".
+CommandResponse SMW_SX1262M0::get_Version(uint8_t (&version)[SMW_SX1262M0_SIZE_VERSION]){
+  // send the command and read the response
+  _send_frame(FRAME_GET_VERSION.data, sizeof(FRAME_GET_VERSION));
+  CommandResponse res = _read_response(TimeoutClass::READ);
+  
+#ifdef SMW_SX1262M0_DEBUG
+  _buffer.print(_stream_debug);
+#endif
+
+  if(res == CommandResponse::OK){
+    // get the data (without a copy)
+    buffer_size_t length = _buffer.available();
+    const uint8_t *data = _buffer.data();
+
+    // reset the parameter
+    for(uint8_t i=0 ; i < SMW_SX1262M0_SIZE_VERSION ; i++){
+      version[i] = 0;
+    }
+
+    // define the substrings to find
+    const char* STR_MAIN = "SX1262";
+    const char* STR_BUILD = "Build";
+
+    // check for STR_MAIN
+    void *ptr = memmem(data, length, STR_MAIN, strlen(STR_MAIN));
+    if(ptr){
+      buffer_size_t index = (ptrdiff_t)ptr - (ptrdiff_t)data;
+      index += strlen(STR_MAIN) + 2; // +"_V"
+      uint8_t vindex = 0;
+      while(index < length){
+        if(isdigit(data[index])){
+          version[vindex] *= 10;
+          version[vindex] += data[index] - '0';
+        } else if(data[index] == '.'){
+          vindex++; // update
+        } else {
+          break; // not supported, exit the loop
+        }
+        
+        index++; // update
+      }
+    }
+
+    // check for STR_BUILD
+    ptr = memmem(data, length, STR_BUILD, strlen(STR_BUILD));
+    if(ptr){
+      buffer_size_t index = (ptrdiff_t)ptr - (ptrdiff_t)data;
+      index += strlen(STR_BUILD) + 1; // +Space
+      uint8_t vindex = SMW_SX1262M0_SIZE_VERSION - 1;
+      while(index < length){
+        if(isdigit(data[index])){
+          version[vindex] *= 10;
+          version[vindex] += data[index] - '0';
+        } else {
+          break; // not supported, exit the loop
+        }
+        
+        index++; // update
+      }
+    }
+  }
+
+  return res;
+}
+
+// --------------------------------------------------
+
+#ifdef SMW_SX1262M0_CACHE
+
+// Invalidate the shadow cache of the parameters
+//  NOTE: the next read of each parameter is sent to the module.
+void SMW_SX1262M0::invalidate_cache(void){
+  _cache.valid = 0;
+}
+
+#endif
+
+// --------------------------------------------------
+
+// Check if the module is connected to the network
+//  @returns true if the device is connected [bool]
+//  NOTE: it is a wrapper around the <get_JoinStatus()> command, which is
+//        skipped if the join was already notified by the module (URC).
+bool SMW_SX1262M0::isConnected(void){
+  // check for the join event
+  _wait(); // finish the pending commands (their responses are not notifications)
+  flush(); // process the notifications
+  if(_joined){
+    return true;
+  }
+
+  uint8_t status = SMW_SX1262M0_JOIN_STATUS_NOT_JOINED; // default
+  if(get_JoinStatus(status) == CommandResponse::OK){
+    if(status == SMW_SX1262M0_JOIN_STATUS_JOINED){
+      return true;
+    }
+  }
+  return false; // default
+}
+
+// --------------------------------------------------
+
+// Join the network
+//  @returns the type of the response [CommandResponse]
+//  NOTE: the confirmation is asynchronous (<get_JoinStatus()>)
+CommandResponse SMW_SX1262M0::join(void){
+  _wait(); // finish the pending commands
+  begin_join();
+  return _wait();
+}
+
+// --------------------------------------------------
+
+// Listen for incoming data in the P2P communication (LoRa Test)
+//  @param (timeout) : the time to wait, in [ms] [uint32_t]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::P2P_listen(uint32_t timeout, Buffer (&buffer)){
+  float rssi, snr;
+  return P2P_listen(timeout, buffer, rssi, snr);
+}
+
+// --------------------------------------------------
+
+// Listen for incoming data in the P2P communication (LoRa Test)
+//  @param (timeout) : the time to wait, in [ms] [uint32_t]
+//  @returns the type of the response [CommandResponse]
+//  NOTE: the data is received directly in <buffer> (no copy), which is
+//        enlarged only when a longer message is received (up to
+//        SMW_SX1262M0_BUFFER_SIZE).
+CommandResponse SMW_SX1262M0::P2P_listen(uint32_t timeout, Buffer (&buffer), float (&rssi), float (&snr)){
+  _wait(); // finish the pending commands
+
+  // receive in the buffer
+  buffer.reset();
+  _p2p_target = &buffer;
+
+  begin_P2P_listen(timeout);
+  CommandResponse res = _wait();
+  _p2p_target = nullptr; // reset
+
+  get_P2P_signal(rssi, snr);
+  return res;
+}
+
+// --------------------------------------------------
+
+// Start the P2P communication (LoRa Test)
+//  @param (frequency) : the frequency to use for the wireless communication, in kHz [uint32_t]
+//         (continuous) : TRUE to make the communication persistent [bool]
+//         (data) : the data to send [char *]. If this parameter is omitted, the module will enter Rx mode instead of Tx.
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::P2P_start(uint32_t frequency, bool continuous, const char *data){
+  // check the frequency
+  if((frequency < 902000) || (frequency > 927800)){
+    return CommandResponse::ERROR;
+  }
+  if((frequency > 907400) && (frequency < 915200)){
+    return CommandResponse::ERROR;
+  }
+
+  // convert the frequency
+  char sfreq[7];
+  sfreq[6] = CHAR_EOS;
+  for(int8_t i=5 ; i >=0 ; i--){
+    sfreq[i] = frequency % 10;
+    sfreq[i] += '0';
+    frequency /= 10;
+  }
+
+  // convert the mode
+  char mode[2];
+  mode[0] = (continuous) ? '1' : '0';
+  mode[1] = CHAR_EOS;
+
+  // check the data
+  if(data == nullptr){
+    _send_command(CMD_LORA_RX, CommandAction::SET, 2, sfreq, mode);
+  } else {
+    _send_command(CMD_LORA_TX, CommandAction::SET, 3, sfreq, mode, data);
+  }
+  
+  return _read_response(TimeoutClass::READ);
+}
+
+// --------------------------------------------------
+
+// Stop the P2P communication (LoRa Test)
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::P2P_stop(void){
+  // flush the serial buffer
+  // NOTE: the serial buffer might have some data because of the P2P output (for Tx and Rx).
+  if(_stream->available()){
+    _stream->read(); // read the incoming byte
+  }
+  
+  _send_frame(FRAME_LORA_OFF.data, sizeof(FRAME_LORA_OFF));
+  return _read_response(TimeoutClass::READ);
+}
+
+// --------------------------------------------------
+
+// Ping the module
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::ping(void){
+  _wait(); // finish the pending commands
+  begin_ping();
+  return _wait();
+}
+
+// --------------------------------------------------
+
+// Advance the pending command
+//  @returns true if the pending command was completed [bool]
+//  NOTE: call this function in the main loop when using the <begin_*()> commands
+//        or the handlers of unsolicited result codes (URC).
+bool SMW_SX1262M0::poll(void){
+  // check for a pending command
+  if(!busy()){
+    flush(); // process the unsolicited result codes
+#ifdef SMW_SX1262M0_CONFIRM
+    _confirm_update(); // send or check the confirmed message
+#endif
+    _spool_update(); // send the oldest stored uplink
+    return false;
+  }
+
+  // read the incoming data
+  uint8_t c;
+  while(_stream->available()){
+    c = _stream->read(); // read the incoming byte
+      
+#ifdef SMW_SX1262M0_DEBUG
+    // debug
+    if(_stream_debug){
+      if(c > 32){
+        _stream_debug->write(c);
+      } else {
+        _stream_debug->print('(');
+        _stream_debug->print(c, HEX);
+        _stream_debug->print(')');
+      }
+    }
+#endif
+
+    switch(_phase){
+      case Phase::RESPONSE: {
+        CommandResponse res;
+        if(_tokenize(c, res)){
+          _record_latency(false);
+          _complete(res);
+          return true;
+        }
+        break;
+      }
+
+      case Phase::RECEIVE: {
+        CommandResponse res;
+        if(_tokenize(c, res)){
+          _record_latency(false);
+          if(res == CommandResponse::OK){
+            _dispatch_downlink();
+          }
+          _complete(res);
+          return true;
+        }
+        break;
+      }
+
+      case Phase::BANNER: {
+        if(_parse_banner(c)){
+          _record_latency(false);
+          _complete(CommandResponse::OK);
+          return true;
+        }
+        break;
+      }
+
+      case Phase::MARKER: {
+        if(_parse_marker(c)){
+          _record_latency(false);
+          _begin(Phase::RESPONSE, TimeoutClass::WRITE, 0, _callback); // this command takes almost X s to reply
+        }
+        break;
+      }
+
+      case Phase::LISTEN: {
+        if(_parse_P2P(c)){
+          _complete(CommandResponse::DATA);
+          return true;
+        }
+        break;
+      }
+
+      default: {
+        // do nothing
+        break;
+      }
+    }
+  }
+
+  // check the timeout (signed difference for the overflow of <millis()>)
+  if(static_cast<int32_t>(millis() - _stop_time) >= 0){
+    switch(_phase){
+      case Phase::BANNER: {
+        _record_latency(true);
+        _complete(CommandResponse::ERROR); // no boot message received
+        return true;
+      }
+
+      case Phase::MARKER: {
+        _record_latency(true);
+        _begin(Phase::RESPONSE, TimeoutClass::WRITE, 0, _callback); // read the response anyway
+        return false;
+      }
+
+      case Phase::LISTEN: {
+        _complete(CommandResponse::OK); // no data received
+        return true;
+      }
+
+      default: {
+        _record_latency(true);
+        _complete(CommandResponse::ERROR); // no status received
+        return true;
+      }
+    }
+  }
+
+#if defined(ARDUINO_ESP8266_GENERIC) || defined(ARDUINO_ESP8266_NODEMCU) || defined(ARDUINO_ESP8266_THING) || defined(ARDUINO_ESP32_DEV)
+// ESP8266 Generic / NodeMCU / Sparkfun The Thing / ESP32 Dev
+  yield(); // custom function for a non blocking execution with the ESP family
+#endif
+
+  return false;
+}
+
+// --------------------------------------------------
+
+// Read a text message from the module
+//  @returns the type of the response [CommandResponse]
+//  NOTE: the data must be obtained from the buffer
+CommandResponse SMW_SX1262M0::readT(void){
+  _wait(); // finish the pending commands
+  begin_readT();
+  return _wait();
+}
+// --------------------------------------------------
+
+// Read a text message from the module
+//  @param (buffer) : the buffer to store the payload [Buffer (&)]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::readT(Buffer (&buffer)){
+  uint8_t port;
+  return readT(port, buffer);
+}
+
+// --------------------------------------------------
+
+// Read a text message from the module
+//  @param (port) : the application port [uint8_t (&)]
+//         (buffer) : the buffer to store the payload [Buffer (&)]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::readT(uint8_t (&port), Buffer (&buffer)){
+  CommandResponse res = readT(); // read the message
+  _copy_downlink(port, buffer);
+  return res;
+}
+
+// --------------------------------------------------
+
+// Read an hexadecimal message from the module
+//  @returns the type of the response [CommandResponse]
+//  NOTE: the data must be obtained from the buffer
+CommandResponse SMW_SX1262M0::readX(void){
+  _wait(); // finish the pending commands
+  begin_readX();
+  return _wait();
+}
+// --------------------------------------------------
+
+// Read an hexadecimal message from the module
+//  @param (buffer) : the buffer to store the payload [Buffer (&)]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::readX(Buffer (&buffer)){
+  uint8_t port;
+  return readX(port, buffer);
+}
+
+// --------------------------------------------------
+
+// Read an hexadecimal message from the module
+//  @param (port) : the application port [uint8_t (&)]
+//         (buffer) : the buffer to store the payload [Buffer (&)]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::readX(uint8_t (&port), Buffer (&buffer)){
+  CommandResponse res = readX(); // read the message
+  _copy_downlink(port, buffer);
+  return res;
+}
+
+// --------------------------------------------------
+
+// Read a binary message from the module
+//  @param (port) : the application port [uint8_t (&)]
+//         (data) : the array to store the payload [uint8_t *]
+//         (capacity) : the size of the array [size_t]
+//         (length) : the variable to store the length of the payload [size_t (&)]
+//  @returns the type of the response [CommandResponse]. PARAM_OVERFLOW if the payload was truncated.
+//  NOTE: the hexadecimal payload is decoded directly in the array.
+CommandResponse SMW_SX1262M0::readX(uint8_t (&port), uint8_t *data, size_t capacity, size_t (&length)){
+  CommandResponse res = readX(); // read the message
+  port = _rx_port;
+  length = 0; // reset
+
+  // check for a valid payload
+  if(!_rx_valid){
+    return res;
+  }
+
+  buffer_size_t size = _buffer.available() - _rx_offset;
+  const char *hex = reinterpret_cast<const char *>(_buffer.data() + _rx_offset);
+  length = hex_decode(data, capacity, hex, size);
+  if((res == CommandResponse::OK) && (length == capacity) && (size > (capacity * 2))){
+    res = CommandResponse::PARAM_OVERFLOW; // truncated
+  }
+  return res;
+}
+
+// --------------------------------------------------
+
+// Reset the module
+//  @param (probe) : true to confirm with <ping()> that the module is ready [bool] (default: false)
+//  @returns the type of the response [CommandResponse]
+//  NOTE: the function returns as soon as the boot message is received. The
+//        probe makes up to SMW_SX1262M0_PROBE_ATTEMPTS pings, with an
+//        increasing delay between them.
+CommandResponse SMW_SX1262M0::reset(bool probe){
+  _wait(); // finish the pending commands
+  begin_reset();
+  CommandResponse res = _wait();
+  if((res != CommandResponse::OK) || !probe){
+    return res;
+  }
+
+  // check if the module is ready
+  uint32_t wait = SMW_SX1262M0_PROBE_DELAY;
+  for(uint8_t i=0 ; i < SMW_SX1262M0_PROBE_ATTEMPTS ; i++){
+    res = ping();
+    if(res == CommandResponse::OK){
+      break;
+    }
+    delay(wait);
+    wait *= 2; // back off
+  }
+  return res;
+}
+
+// --------------------------------------------------
+
+// Save the current configuration
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::save(void){
+  _wait(); // finish the pending commands
+  begin_save();
+  return _wait();
+}
+
+// --------------------------------------------------
+
+// Send a text message
+//  @param (port) : the application port [uint8_t]
+//         (data) : the text data to send [char *]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::sendT(uint8_t port, const char *data){
+  _wait(); // finish the pending commands
+  CommandResponse res = _check_uplink(strlen(data));
+  if(res != CommandResponse::OK){
+    return res;
+  }
+  begin_sendT(port, data);
+  return _wait();
+}
+
+// --------------------------------------------------
+
+// Send a text message
+//  @param (port) : the application port [uint8_t]
+//         (data) : the text data to send [String]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::sendT(uint8_t port, const String data){
+  CommandResponse res = _begin_stream(CMD_SEND, port, false);
+  if(res != CommandResponse::OK){
+    return res;
+  }
+  _writer.write(data.c_str(), data.length()); // no temporary copy
+  return end_send();
+}
+
+// --------------------------------------------------
+
+// Send an hexadecimal message
+//  @param (port) : the application port [uint8_t]
+//         (data) : the text data to send [char *]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::sendX(uint8_t port, const char *data){
+  _wait(); // finish the pending commands
+  size_t length = strlen(data);
+  CommandResponse res = _check_uplink(length / 2);
+  if(res == CommandResponse::OK){
+    begin_sendX(port, data);
+    res = _wait();
+  }
+  _spool_store(port, data, length, res);
+  return res;
+}
+
+// --------------------------------------------------
+
+// Send an hexadecimal message
+//  @param (port) : the application port [uint8_t]
+//         (data) : the text data to send [String]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::sendX(uint8_t port, const String data){
+  CommandResponse res = _begin_stream(CMD_SENDB, port, false); // already hexadecimal
+  if(res == CommandResponse::OK){
+    _writer.write(data.c_str(), data.length()); // no temporary copy
+    res = end_send();
+  }
+  _spool_store(port, data.c_str(), data.length(), res);
+  return res;
+}
+
+// --------------------------------------------------
+
+// Send a binary message
+//  @param (port) : the application port [uint8_t]
+//         (data) : the bytes to send [uint8_t *]
+//         (length) : the number of bytes [size_t]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::sendX(uint8_t port, const uint8_t *data, size_t length){
+  _wait(); // finish the pending commands
+  CommandResponse res = _check_uplink(length);
+  if(res == CommandResponse::OK){
+    begin_sendX(port, data, length);
+    res = _wait();
+  }
+  _spool_store(port, data, length, res);
+  return res;
+}
+
+// --------------------------------------------------
+
+// Set a parameter
+//  @param (value) : the value to be sent [input of the parameter]
+//  @returns the type of the response [CommandResponse]
+template <Param P>
+CommandResponse SMW_SX1262M0::set(typename ParamDescriptor<P>::input value){
+  _wait(); // finish the pending commands
+  if(!begin_set<P>(value)){
+    return CommandResponse::ERROR;
+  }
+
+  CommandResponse res = _wait();
+#ifdef SMW_SX1262M0_CACHE
+  if(res == CommandResponse::OK){
+    ParamShadow<P>::store(_cache, value); // write-through (after the reset, if any)
+  }
+#endif
+  return res;
+}
+
+// --------------------------------------------------
+
+// Set the Adaptive Data Rate
+//  @param (adr) : the data to be sent [uint8_t]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::set_ADR(uint8_t adr){
+  return set<Param::ADR>(adr);
+}
+
+// --------------------------------------------------
+
+// Set the Automatic Join
+//  @param (ajoin) : the data to be sent [uint8_t]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::set_AJoin(uint8_t ajoin){
+  return set<Param::AJOIN>(ajoin);
+}
+
+// --------------------------------------------------
+
+// Set the Application EUI
+//  @param (appeui) : the array with the data to be sent [char *]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::set_AppEUI(const char *appeui){
+  return set<Param::APPEUI>(appeui);
+}
+
+// --------------------------------------------------
+
+// Set the Application Key
+//  @param (appkey) : the array with the data to be sent [char *]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::set_AppKey(const char *appkey){
+  return set<Param::APPKEY>(appkey);
+}
+
+// --------------------------------------------------
+
+// Set the Application Session Key
+//  @param (appskey) : the array with the data to be sent [char *]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::set_AppSKey(const char *appskey){
+  return set<Param::APPSKEY>(appskey);
+}
+
+// --------------------------------------------------
+
+#ifdef SMW_SX1262M0_CONFIRM
+
+// Set the handler of the confirmed messages
+//  @param (handler) : the function to call when a message is acknowledged or failed, or null to ignore [ConfirmCallback]
+void SMW_SX1262M0::set_confirm_handler(ConfirmCallback handler){
+  _confirm_handler = handler;
+}
+
+#endif
+
+// --------------------------------------------------
+
+// Set the Confirm Mode
+//  @param (confirmed) : the data to be sent [uint8_t]
+//  @returns the type of the response [CommandResponse]
+//  NOTE: applies to all the uplinks (see <begin_send_confirmed()> for a single message).
+CommandResponse SMW_SX1262M0::set_Confirmed(uint8_t confirmed){
+  return set<Param::CFM>(confirmed);
+}
+
+// --------------------------------------------------
+
+// Set the debugger of the object
+//  @param (debugger) : the stream to print to [Stream *]
+#ifdef SMW_SX1262M0_DEBUG
+void SMW_SX1262M0::set_debugger(Stream *debugger){
+  _stream_debug = debugger;
+}
+#endif
+
+// --------------------------------------------------
+
+// Set the Device Address
+//  @param (devaddr) : the array with the data to be sent [char *]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::set_DevAddr(const char *devaddr){
+  return set<Param::DADDR>(devaddr);
+}
+
+// --------------------------------------------------
+
+// Set the handler of the downlinks received on a port
+//  @param (port) : the application port [uint8_t]
+//         (handler) : the function to call with the payload, or null to remove the handler [DownlinkCallback]
+//  @returns false if there is no space for another handler [bool]
+//  NOTE: the handlers are called when the response of <readT()> or <readX()> is received.
+//        The payload points to the buffer of the object and is valid only during the call.
+bool SMW_SX1262M0::set_downlink_handler(uint8_t port, DownlinkCallback handler){
+  // check if the port is already registered
+  uint8_t index = SMW_SX1262M0_DOWNLINK_HANDLERS; // default
+  for(uint8_t i=0 ; i < SMW_SX1262M0_DOWNLINK_HANDLERS ; i++){
+    if(_downlink_handlers[i].handler && (_downlink_handlers[i].port == port)){
+      index = i;
+      break;
+    } else if(!_downlink_handlers[i].handler && (index == SMW_SX1262M0_DOWNLINK_HANDLERS)){
+      index = i; // first free slot
+    }
+  }
+
+  // check for a valid slot
+  if(index == SMW_SX1262M0_DOWNLINK_HANDLERS){
+    return (handler == nullptr);
+  }
+
+  _downlink_handlers[index].port = port;
+  _downlink_handlers[index].handler = handler;
+  return true;
+}
+
+// --------------------------------------------------
+
+// Set the Data Rate
+//  @param (dr) : the data to be sent [uint8_t]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::set_DR(uint8_t dr){
+  CommandResponse res = set<Param::DR>(dr);
+  if(res == CommandResponse::OK){
+    _data_rate = dr; // update
+  }
+  return res;
+}
+
+// --------------------------------------------------
+
+// Set the Join Mode
+//  @param (mode) : the data to be sent [uint8_t]
+//  @returns the type of the response [CommandResponse]
+//  NOTE: this command resets the module, but returns "OK" after completion
+CommandResponse SMW_SX1262M0::set_JoinMode(uint8_t mode){
+  return set<Param::NJM>(mode);
+}
+
+// --------------------------------------------------
+
+// Set the Network Session Key
+//  @param (nwkskey) : the array with the data to be sent [char *]
+//  @returns the type of the response [CommandResponse]
+CommandResponse SMW_SX1262M0::set_NwkSKey(const char *nwkskey){
+  return set<Param::NWKSKEY>(nwkskey);
+}
+
+// --------------------------------------------------
+
+// Set the spool of the uplinks
+//  @param (spool) : the spool to store the uplinks that couldn't be sent, or null to disable [Spool *]
+//  NOTE: the binary uplinks of <sendX()> that return NO_NETWORK or BUSY are
+//        stored and sent by <poll()> in the same order, through the
+//        scheduler of the uplinks. The new uplinks are sent before the
+//        stored ones (the stored uplinks are sent when the module is idle).
+//        Call <begin()> of the spool before.
+void SMW_SX1262M0::set_spool(Spool *spool){
+  _spool = spool;
+  _spool_time = millis();
+  _spool_sending = false; // reset
+}
+
+// --------------------------------------------------
+
+#ifdef SMW_SX1262M0_ADAPTIVE_TIMEOUT
+
+// Set the policy of the adaptive timeouts
+//  @param (percentile) : the percentile of the observed latencies [uint8_t] (1-100)
+//         (margin) : the margin added to the percentile in miliseconds [uint16_t]
+void SMW_SX1262M0::set_timeout_policy(uint8_t percentile, uint16_t margin){
+  if(percentile == 0){
+    percentile = 1;
+  } else if(percentile > 100){
+    percentile = 100;
+  }
+  _timeout_percentile = percentile;
+  _timeout_margin = margin;
+}
+
+#endif
+
+// --------------------------------------------------
+
+// Set the handler of an unsolicited result code (URC)
+//  @param (type) : the type of the URC [URCType]
+//         (handler) : the function to call when the URC is received, or null to ignore it [URCCallback]
+//  NOTE: the handlers are called from <poll()>, <flush()> and while reading the response of a command.
+//        The data is valid until the next command is sent.
+void SMW_SX1262M0::set_URC_handler(URCType type, URCCallback handler){
+  _urc_handlers[static_cast<uint8_t>(type)] = handler;
+}
+
+// --------------------------------------------------
+
+// Take the buffered data
+//  @param (buffer) : the variable to store the result [Buffer(&)]
+//  NOTE: the data is exchanged with the buffer (<Buffer::swap()>) and the
+//        buffered data is cleared. The variable is only resized when it is
+//        smaller than the data, so it can be reused without allocations.
+void SMW_SX1262M0::take_buffer(Buffer (&buffer)){
+  // fit the data (the internal buffer is static, so the memory can't be handed over)
+  buffer_size_t length = _buffer.available();
+  if(buffer.size() < length){
+    buffer.resize(length);
+  }
+
+  buffer.swap(_buffer);
+  _buffer.reset();
+}
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+// Complete a command of <apply()>
+//  @param (param) : the parameter of the command [Param]
+//         (response) : the type of the response [CommandResponse]
+void SMW_SX1262M0::_apply_complete(Param param, CommandResponse response){
+  if(_apply_config == nullptr){
+    return;
+  }
+
+  if(_apply_reading){
+    // compare the value read (a parameter that can't be read is set anyway)
+    if((response != CommandResponse::OK) || !_apply_step(param, ApplyStep::COMPARE)){
+      _apply_mask |= param_bit(param);
+    }
+  } else if(response == CommandResponse::OK){
+    _apply_step(param, ApplyStep::STORE);
+  } else if(_apply_response == CommandResponse::OK){
+    _apply_response = response; // keep the first error
+  }
+}
+
+// --------------------------------------------------
+
+// Read the parameters of <apply()> in a single batch
+//  @param (mask) : the parameters to read [uint16_t]
+//  @returns the parameters that differ from the configuration [uint16_t]
+uint16_t SMW_SX1262M0::_apply_read(uint16_t mask){
+  _apply_mask = 0; // reset
+  _apply_reading = true; // set
+
+  for(uint8_t i=0 ; (i < (sizeof(APPLY_ORDER) / sizeof(APPLY_ORDER[0]))) && (_apply_response == CommandResponse::OK) ; i++){
+    Param param = progmem_read(APPLY_ORDER[i]);
+    if(mask & param_bit(param)){
+      // wait for space in the queue
+      while(_queue_count >= SMW_SX1262M0_QUEUE_SIZE){
+        poll();
+      }
+      if(!_apply_step(param, ApplyStep::READ)){
+        _apply_mask |= param_bit(param); // set anyway
+      }
+    }
+  }
+  _wait();
+
+  _apply_reading = false; // reset
+  return _apply_mask;
+}
+
+// --------------------------------------------------
+
+// Run a step of <apply()> for a parameter of the configuration
+//  @param (param) : the parameter [Param]
+//         (step) : the step [ApplyStep]
+//  @returns the result of the step [bool]
+bool SMW_SX1262M0::_apply_step(Param param, ApplyStep step){
+  const SMW_SX1262M0_Config &config = *_apply_config;
+  switch(param){
+    case Param::ADR: return _apply_step<Param::ADR>(config.adr, step);
+    case Param::AJOIN: return _apply_step<Param::AJOIN>(config.ajoin, step);
+    case Param::APPEUI: return _apply_step<Param::APPEUI>(config.appeui, step);
+    case Param::APPKEY: return _apply_step<Param::APPKEY>(config.appkey, step);
+    case Param::APPSKEY: return _apply_step<Param::APPSKEY>(config.appskey, step);
+    case Param::CFM: return _apply_step<Param::CFM>(config.confirmed, step);
+    case Param::DADDR: return _apply_step<Param::DADDR>(config.devaddr, step);
+    case Param::DR: return _apply_step<Param::DR>(config.dr, step);
+    case Param::NJM: return _apply_step<Param::NJM>(config.join_mode, step);
+    case Param::NWKSKEY: return _apply_step<Param::NWKSKEY>(config.nwkskey, step);
+    default: return false;
+  }
+}
+
+// --------------------------------------------------
+
+// Run a step of <apply()> for a parameter
+//  @param (value) : the desired value [input of the parameter]
+//         (step) : the step [ApplyStep]
+//  @returns the result of the step [bool]
+//  NOTE: READ queues the GET command (or compares the cached value), COMPARE
+//        checks the response in the buffer, SET queues the SET command and
+//        STORE updates the state of the driver after the SET command.
+template <Param P>
+bool SMW_SX1262M0::_apply_step(typename ParamDescriptor<P>::input value, ApplyStep step){
+  typedef ParamDescriptor<P> Descriptor;
+  typedef ParamCodec<Descriptor::policy> Codec;
+
+  switch(step){
+    case ApplyStep::READ: {
+      // check the value
+      char str[(Descriptor::width * 3 / 2) + 1];
+      if(!Codec::template format<Descriptor>(str, value)){
+        _apply_response = CommandResponse::PARAM_ERROR;
+        return true; // not applied
+      }
+
+#ifdef SMW_SX1262M0_CACHE
+      // check the cache
+      typename Descriptor::type current;
+      if(ParamShadow<P>::read(_cache, current)){
+        _cache_hits++;
+        typename Descriptor::type desired;
+        Codec::template decode<Descriptor>(str, desired);
+        return Codec::template equal<Descriptor>(current, desired);
+      }
+      if(Descriptor::cached){
+        _cache_misses++;
+      }
+#endif
+
+      // queue the command
+      _queue_frame(ParamFrame<P>::frame.data, sizeof(ParamFrame<P>::frame));
+      if(!_queue_push(Phase::RESPONSE, Descriptor::timeout_get, nullptr)){
+        return false;
+      }
+      _queue[(_queue_head + _queue_count - 1) % SMW_SX1262M0_QUEUE_SIZE].apply = true;
+      _queue[(_queue_head + _queue_count - 1) % SMW_SX1262M0_QUEUE_SIZE].param = P;
+      return true;
+    }
+
+    case ApplyStep::COMPARE: {
+      typename Descriptor::type current;
+      Codec::template parse<Descriptor>(_buffer, current);
+#ifdef SMW_SX1262M0_CACHE
+      ParamShadow<P>::write(_cache, current);
+#endif
+
+      char str[(Descriptor::width * 3 / 2) + 1];
+      typename Descriptor::type desired;
+      Codec::template format<Descriptor>(str, value); // already checked
+      Codec::template decode<Descriptor>(str, desired);
+      return Codec::template equal<Descriptor>(current, desired);
+    }
+
+    case ApplyStep::SET: {
+      if(!begin_set<P>(value)){
+        return false;
+      }
+      _queue[(_queue_head + _queue_count - 1) % SMW_SX1262M0_QUEUE_SIZE].apply = true;
+      _queue[(_queue_head + _queue_count - 1) % SMW_SX1262M0_QUEUE_SIZE].param = P;
+      return true;
+    }
+
+    case ApplyStep::STORE: {
+#ifdef SMW_SX1262M0_CACHE
+      ParamShadow<P>::store(_cache, value); // write-through (after the reset, if any)
+#endif
+      if(P == Param::DR){
+        _data_rate = _apply_config->dr; // update
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+// --------------------------------------------------
+
+// Queue the SET commands of <apply()>
+//  @param (mask) : the parameters to set [uint16_t]
+//  NOTE: the commands are pipelined, so call <_wait()> to complete them.
+void SMW_SX1262M0::_apply_write(uint16_t mask){
+  for(uint8_t i=0 ; i < (sizeof(APPLY_ORDER) / sizeof(APPLY_ORDER[0])) ; i++){
+    Param param = progmem_read(APPLY_ORDER[i]);
+    if(mask & param_bit(param)){
+      // wait for space in the queue (64 bytes for the longest frame, with a key)
+      while((_queue_count >= SMW_SX1262M0_QUEUE_SIZE) ||
+          ((_queue_count > 0) && ((SMW_SX1262M0_QUEUE_BUFFER_SIZE - _queue_data_count) < 64))){
+        poll();
+      }
+      if(!_apply_step(param, ApplyStep::SET) && (_apply_response == CommandResponse::OK)){
+        _apply_response = CommandResponse::ERROR;
+      }
+    }
+  }
+}
+
+// --------------------------------------------------
+
+// Start waiting for the response of a command
+//  @param (phase) : the phase of the response [Phase]
+//         (type) : the class of the timeout [TimeoutClass]
+//         (timeout) : the time to wait for the response in miliseconds, for the NONE class [uint32_t]
+//         (callback) : the function to call on completion [CommandCallback]
+void SMW_SX1262M0::_begin(Phase phase, TimeoutClass type, uint32_t timeout, CommandCallback callback){
+  _phase = phase;
+  _callback = callback;
+  _timeout_class = type;
+  _start_time = millis();
+  _stop_time = _start_time + ((type == TimeoutClass::NONE) ? timeout : get_timeout(type));
+
+  // reset the parsers
+  _buffer.reset();
+  _line_open = false;
+  _found = false;
+  _match_index = 0;
+  _p2p_field = P2PField::NOTHING;
+  switch(phase){
+    case Phase::BANNER: {
+      _matcher.load(TABLE_BANNER);
+      break;
+    }
+
+    case Phase::MARKER: {
+      _matcher.load(TABLE_MARKER);
+      break;
+    }
+
+    case Phase::LISTEN: {
+      _matcher.load(TABLE_P2P);
+      break;
+    }
+
+    default: {
+      _matcher.reset();
+      break;
+    }
+  }
+  _rx_parsing = (phase == Phase::RECEIVE);
+  _rx_valid = false;
+  _rx_port = 0;
+  _rx_offset = 0;
+}
+
+// --------------------------------------------------
+
+// Send a message
+//  @param (command) : the command to send [char *]
+//         (port) : the application port [uint8_t]
+//         (data) : the data to send [char *]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+bool SMW_SX1262M0::_begin_send(const char *command, uint8_t port, const char *data, CommandCallback callback){
+  size_t length = strlen(data);
+  if(command == CMD_SENDB){
+    length /= 2; // hexadecimal
+  }
+  if(_check_uplink(length) != CommandResponse::OK){
+    return false;
+  }
+
+  char sport[4]; // port stringified (0 to 999)
+  format_port(sport, port);
+  
+  // queue the command
+  _queue_command(command, CommandAction::SET, 2, sport, data);
+  return _push_uplink(length, callback); // this command takes some time to reply
+}
+
+// --------------------------------------------------
+
+// Start the frame of a message with a streaming payload
+//  @param (command) : the command to send [char *]
+//         (port) : the application port [uint8_t]
+//         (encode) : true to encode the payload as hexadecimal [bool]
+//  @returns OK if the frame was started, or the reason the uplink is not allowed [CommandResponse]
+//  NOTE: the pending commands are completed first, so the frame is written
+//        directly to the module.
+CommandResponse SMW_SX1262M0::_begin_stream(const char *command, uint8_t port, bool encode){
+  _wait(); // finish the pending commands
+
+  // check the scheduler (the length is unknown yet)
+  CommandResponse res = _check_uplink(0);
+  if(res != CommandResponse::OK){
+    _writer._open = false;
+    _writer._refusal = res;
+    return res;
+  }
+
+  char sport[4]; // port stringified (0 to 999)
+  format_port(sport, port);
+
+  // write the header
+  char frame[SMW_SX1262M0_FRAME_SIZE];
+  uint8_t length = 0;
+  const char separator[] = {CHAR_COLON, CHAR_EOS};
+  const char assignment[] = {CHAR_EQUAL, CHAR_EOS};
+  _frame_begin();
+  length = _frame_append(frame, length, FRAME_PREFIX);
+  length = _frame_append(frame, length, command);
+  length = _frame_append(frame, length, assignment);
+  length = _frame_append(frame, length, sport);
+  length = _frame_append(frame, length, separator);
+  _frame_write(frame, length);
+
+  _writer._encode = encode;
+  _writer._hexadecimal = !encode && (command == CMD_SENDB);
+  _writer._length = 0;
+  _writer._open = true;
+  return CommandResponse::OK;
+}
+
+// --------------------------------------------------
+
+// Check if an uplink is allowed now
+//  @param (length) : the length of the payload [bytes]
+//  @returns OK, BUSY if the uplink must wait or PARAM_OVERFLOW if it can't be sent [CommandResponse]
+CommandResponse SMW_SX1262M0::_check_uplink(size_t length){
+  uint32_t wait = get_send_delay(length);
+  if(wait == AIRTIME_NEVER){
+    return CommandResponse::PARAM_OVERFLOW;
+  } else if(wait > 0){
+    return CommandResponse::BUSY;
+  }
+  return CommandResponse::OK;
+}
+
+// --------------------------------------------------
+
+// Complete the pending command
+//  @param (response) : the type of the response [CommandResponse]
+void SMW_SX1262M0::_complete(CommandResponse response){
+  // release the time on air of a rejected uplink (the module is not busy)
+  if((_queue[_queue_head].type == TimeoutClass::SEND) && (response != CommandResponse::OK) &&
+      (response != CommandResponse::BUSY)){
+    _scheduler.cancel();
+  }
+
+  // update the configuration
+  if(_queue[_queue_head].apply){
+    _apply_complete(_queue[_queue_head].param, response);
+  }
+
+#ifdef SMW_SX1262M0_CONFIRM
+  // update the confirmed message
+  if(_queue[_queue_head].confirm){
+    _confirm_complete(response);
+  }
+#endif
+
+  // update the stored uplink
+  if(_queue[_queue_head].spool){
+    _spool_complete(response);
+  }
+
+  // remove the command from the queue
+  _queue_head = (_queue_head + 1) % SMW_SX1262M0_QUEUE_SIZE;
+  _queue_count--;
+  _queue_sent--;
+
+  _phase = Phase::NONE;
+  _response = response;
+
+  // call the callback (it can queue another command)
+  if(_callback){
+    CommandCallback callback = _callback;
+    _callback = nullptr; // reset
+    callback(response, _buffer);
+  }
+
+  _pump(); // send the next commands
+}
+
+// --------------------------------------------------
+
+#ifdef SMW_SX1262M0_CONFIRM
+
+// Complete a command of the confirmed message
+//  @param (response) : the type of the response [CommandResponse]
+void SMW_SX1262M0::_confirm_complete(CommandResponse response){
+  switch(_confirm_state){
+    case ConfirmState::SENDING: {
+      if(response == CommandResponse::OK){
+        // wait for the receive windows
+        uint32_t toa = (_data_rate <= AIRTIME_DR_MAX) ? (airtime(_data_rate, _confirm_length) / 1000) : 0;
+        _confirm_time = millis() + toa + SMW_SX1262M0_RX_WINDOWS;
+        _confirm_state = ConfirmState::WAIT;
+      } else {
+        _confirm_resolve(ConfirmStatus::PENDING); // retry
+      }
+      break;
+    }
+
+    case ConfirmState::CHECK: {
+      if(response == CommandResponse::OK){
+        ParamCodec<ParamPolicy::DIGIT>::parse<ParamDescriptor<Param::CFM>>(_buffer, _confirm_mode);
+      }
+      if(_confirm_mode != SMW_SX1262M0_CONFIG_KEEP){
+        _confirm_state = ConfirmState::SEND; // send in the next update
+      } else {
+        _confirm_attempts++; // update (the read counts as an attempt)
+        _confirm_resolve(ConfirmStatus::PENDING); // retry
+      }
+      break;
+    }
+
+    case ConfirmState::QUERY: {
+      uint8_t status = 0;
+      if(response == CommandResponse::OK){
+        ParamCodec<ParamPolicy::DIGIT>::parse<ParamDescriptor<Param::CFS>>(_buffer, status);
+      }
+      _confirm_resolve((status == 1) ? ConfirmStatus::ACKNOWLEDGED : ConfirmStatus::PENDING);
+      break;
+    }
 
-//      _connected = (b == '1') ? true : false; // update (ASCII of SMW_SX1262M0_JOIN_STATUS_JOINED)
+    default: {
+      // do nothing
+      break;
     }
   }
+}
 
-  return res;
+// --------------------------------------------------
+
+// Resolve an attempt of the confirmed message
+//  @param (status) : ACKNOWLEDGED, or PENDING to retry the message [ConfirmStatus]
+//  NOTE: the message fails after the last attempt.
+void SMW_SX1262M0::_confirm_resolve(ConfirmStatus status){
+  if((status == ConfirmStatus::PENDING) && (_confirm_attempts < SMW_SX1262M0_CONFIRM_ATTEMPTS)){
+    // schedule the retransmission (exponential backoff)
+    _confirm_time = millis() + (static_cast<uint32_t>(SMW_SX1262M0_CONFIRM_BACKOFF) << (_confirm_attempts - 1));
+    _confirm_state = ConfirmState::SEND;
+    return;
+  }
+
+  _confirm_status = (status == ConfirmStatus::ACKNOWLEDGED) ? status : ConfirmStatus::FAILED;
+  _confirm_state = ConfirmState::IDLE;
+
+  // restore the Confirm Mode (to the value read before the message)
+  if(_confirm_restore){
+    _confirm_restore = false; // reset
+    begin_set<Param::CFM>(_confirm_mode);
+  }
+  _confirm_mode = SMW_SX1262M0_CONFIG_KEEP; // reset
+
+  // call the handler
+  if(_confirm_handler){
+    _confirm_handler(_confirm_ticket, _confirm_status);
+  }
 }
 
 // --------------------------------------------------
 
-// Get the Network Session Key
-//  @param (nwkskey) : the array to store the result [char[n]]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_NwkSKey(char (&nwkskey)[SMW_SX1262M0_SIZE_NWKSKEY]){
-  // send the command and read the response
-  _send_command(CMD_NWKSKEY, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
+// Update the confirmed message
+//  NOTE: called by <poll()> when there are no pending commands.
+void SMW_SX1262M0::_confirm_update(void){
+  if(static_cast<int32_t>(millis() - _confirm_time) < 0){
+    return; // not yet
+  }
+
+  switch(_confirm_state){
+    case ConfirmState::SEND: {
+      // check the scheduler
+      CommandResponse res = _check_uplink(_confirm_length);
+      if(res == CommandResponse::PARAM_OVERFLOW){
+        _confirm_attempts = SMW_SX1262M0_CONFIRM_ATTEMPTS; // no retry
+        _confirm_resolve(ConfirmStatus::FAILED);
+        return;
+      } else if(res != CommandResponse::OK){
+        return; // try again later
+      }
+
+      // read the Confirm Mode (only once per message)
+      if(_confirm_mode == SMW_SX1262M0_CONFIG_KEEP){
+#ifdef SMW_SX1262M0_CACHE
+        if(!ParamShadow<Param::CFM>::read(_cache, _confirm_mode))
 #endif
+        {
+          _queue_frame(ParamFrame<Param::CFM>::frame.data, sizeof(ParamFrame<Param::CFM>::frame));
+          if(_queue_push(Phase::RESPONSE, TimeoutClass::READ, nullptr)){
+            _queue[(_queue_head + _queue_count - 1) % SMW_SX1262M0_QUEUE_SIZE].confirm = true;
+            _confirm_state = ConfirmState::CHECK;
+          }
+          return;
+        }
+      }
 
-  if(res == CommandResponse::OK){
-    uint8_t length = _buffer.available();
-    uint8_t index = 0;
-    for(uint8_t i=0 ; i < SMW_SX1262M0_SIZE_NWKSKEY ; i++){
-      if(isxdigit(_buffer[index])){
-        nwkskey[i] = _buffer[index++];
-      } else {
-        index++; // go the next
-        i--; // repeat the loop with the same index
+      // enable the Confirm Mode
+      if(!_confirm_restore && (_confirm_mode != SMW_SX1262M0_CONFIRMED_ON)){
+        if(!begin_set<Param::CFM>(SMW_SX1262M0_CONFIRMED_ON)){
+          return; // try again later
+        }
+        _confirm_restore = true; // set
       }
 
-      // check for end of buffer
-      if(index >= length){
-        break;
+      // send the message
+      if(begin_sendX(_confirm_port, _confirm_data, _confirm_length)){
+        _queue[(_queue_head + _queue_count - 1) % SMW_SX1262M0_QUEUE_SIZE].confirm = true;
+        _confirm_attempts++;
+        _confirm_state = ConfirmState::SENDING;
       }
+      break;
     }
-    if(length < SMW_SX1262M0_SIZE_NWKSKEY){
-      nwkskey[length] = CHAR_EOS;
+
+    case ConfirmState::WAIT: {
+      // read the status of the acknowledgement
+      _queue_frame(ParamFrame<Param::CFS>::frame.data, sizeof(ParamFrame<Param::CFS>::frame));
+      if(_queue_push(Phase::RESPONSE, TimeoutClass::READ, nullptr)){
+        _queue[(_queue_head + _queue_count - 1) % SMW_SX1262M0_QUEUE_SIZE].confirm = true;
+        _confirm_state = ConfirmState::QUERY;
+      }
+      break;
     }
-  }
 
-  return res;
+    default: {
+      // do nothing
+      break;
+    }
+  }
 }
 
-// --------------------------------------------------
-
-// Get the RSSI of the last received data
-//  @param (rssi) : the variable to store the result [float (&)]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_RSSI(float (&rssi)){
-  // send the command and read the response
-  _send_command(CMD_RSSI, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
 #endif
 
-  if(res == CommandResponse::OK){
-    char buffer_value[6] = { '0' }; // default value is 0
-    uint8_t index = 0;
-    while(_buffer.available()){
-      char c = _buffer.read();
-      if(isdigit(c) || (c == '-')){
-        buffer_value[index++] = c;
-      }
-    }
-    rssi = atof(buffer_value);
+// --------------------------------------------------
+
+// Copy the payload of the last downlink
+//  @param (port) : the variable to store the application port [uint8_t (&)]
+//         (buffer) : the buffer to store the payload [Buffer (&)]
+//  NOTE: the buffer is resized only if it is too small for the payload.
+void SMW_SX1262M0::_copy_downlink(uint8_t (&port), Buffer (&buffer)){
+  port = _rx_port;
+  buffer.reset();
+
+  // check for a valid payload
+  if(!_rx_valid){
+    return;
   }
 
-  return res;
+  buffer_size_t length = _buffer.available() - _rx_offset;
+  if(buffer.size() < length){
+    buffer.resize(length);
+  }
+  const uint8_t *data = _buffer.data() + _rx_offset;
+  for(buffer_size_t i=0 ; i < length ; i++){
+    buffer.append(data[i]);
+  }
 }
 
 // --------------------------------------------------
 
-// Get the SNR of the last received data
-//  @param (snr) : the variable to store the result [float (&)]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::get_SNR(float (&snr)){
-  // send the command and read the response
-  _send_command(CMD_SNR, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
+// Custom delay in miliseconds
+//  @param (duration) : the duration of the delay in miliseconds [uint32_t]
+void SMW_SX1262M0::_delay(uint32_t duration){
+  uint32_t start_time = millis();
+  while((millis() - start_time) < duration){
+#if defined(ARDUINO_ESP8266_GENERIC) || defined(ARDUINO_ESP8266_NODEMCU) || defined(ARDUINO_ESP8266_THING) || defined(ARDUINO_ESP32_DEV)
+// ESP8266 Generic / NodeMCU / Sparkfun The Thing / ESP32 Dev
+    yield(); // custom function for a non blocking execution with the ESP family
+#else
+    // do nothing
 #endif
+  }
+}
 
-  if(res == CommandResponse::OK){
-    char buffer_value[6] = { '0' }; // default value is 0
-    uint8_t index = 0;
-    while(_buffer.available()){
-      char c = _buffer.read();
-      if(isdigit(c) || (c == '-')){
-        buffer_value[index++] = c;
-      }
-    }
-    snr = atof(buffer_value);
+// --------------------------------------------------
+
+// Dispatch the payload of the last downlink to the handler of its port
+void SMW_SX1262M0::_dispatch_downlink(void){
+  // check for a valid payload
+  if(!_rx_valid || (_buffer.available() <= _rx_offset)){
+    return;
   }
 
-  return res;
+  // search for the handler
+  for(uint8_t i=0 ; i < SMW_SX1262M0_DOWNLINK_HANDLERS ; i++){
+    if(_downlink_handlers[i].handler && (_downlink_handlers[i].port == _rx_port)){
+      _downlink_handlers[i].handler(_rx_port, _buffer.data() + _rx_offset, _buffer.available() - _rx_offset);
+      return;
+    }
+  }
 }
 
 // --------------------------------------------------
 
-// Get the Version
-//  @param (version) : the array to store the result [uint8_t[n]]
-//  @returns the type of the response [CommandResponse]
-//  NOTE: currently tested only with "v1.2 build 38".
-CommandResponse SMW_SX1262M0::get_Version(uint8_t (&version)[SMW_SX1262M0_SIZE_VERSION]){
-  // send the command and read the response
-  _send_command(CMD_VERSION, CommandAction::GET);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_READ);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  _buffer.print(_stream_debug);
+// Dispatch the unsolicited result code (URC) stored in the URC buffer
+//  @param (type) : the type of the URC [URCType]
+void SMW_SX1262M0::_dispatch_URC(URCType type){
+  // update the status of the module
+  switch(type){
+    case URCType::BOOT: {
+      _joined = false; // the module was reset
+#ifdef SMW_SX1262M0_CACHE
+      invalidate_cache();
 #endif
-
-  if(res == CommandResponse::OK){
-    // copy the buffer
-    uint8_t length = _buffer.available();
-    uint8_t data[length];
-    _buffer.copy(data);
-
-    // reset the parameter
-    for(uint8_t i=0 ; i < SMW_SX1262M0_SIZE_VERSION ; i++){
-      version[i] = 0;
+      break;
     }
 
-    // define the substrings to find
-    const char* STR_MAIN = "SX1262";
-    const char* STR_BUILD = "Build";
-
-    // check for STR_MAIN
-    void *ptr = memmem(data, length, STR_MAIN, strlen(STR_MAIN));
-    if(ptr){
-      uint8_t index = (ptrdiff_t)ptr - (ptrdiff_t)data;
-      index += strlen(STR_MAIN) + 2; // +"_V"
-      uint8_t vindex = 0;
-      while(index < length){
-        if(isdigit(data[index])){
-          version[vindex] *= 10;
-          version[vindex] += data[index] - '0';
-        } else if(data[index] == '.'){
-          vindex++; // update
-        } else {
-          break; // not supported, exit the loop
-        }
-        
-        index++; // update
-      }
+    case URCType::JOINED: {
+      _joined = true; // set
+      _spool_time = millis(); // send the stored uplinks
+#ifdef SMW_SX1262M0_CACHE
+      invalidate_cache(); // the session was renewed
+#endif
+      break;
     }
 
-    // check for STR_BUILD
-    ptr = memmem(data, length, STR_BUILD, strlen(STR_BUILD));
-    if(ptr){
-      uint8_t index = (ptrdiff_t)ptr - (ptrdiff_t)data;
-      index += strlen(STR_BUILD) + 1; // +Space
-      uint8_t vindex = SMW_SX1262M0_SIZE_VERSION - 1;
-      while(index < length){
-        if(isdigit(data[index])){
-          version[vindex] *= 10;
-          version[vindex] += data[index] - '0';
-        } else {
-          break; // not supported, exit the loop
-        }
-        
-        index++; // update
-      }
+    default: {
+      // do nothing
+      break;
     }
   }
 
-  return res;
+  // call the handler
+  URCCallback handler = _urc_handlers[static_cast<uint8_t>(type)];
+  if(handler){
+    handler(type, _urc_buffer);
+  }
 }
 
 // --------------------------------------------------
 
-// Check if the module is connected to the network
-//  @returns true if the device is connected [bool]
-//  NOTE: it is a wrapper around the <get_JoinStatus()> command
-bool SMW_SX1262M0::isConnected(void){
-  uint8_t status = SMW_SX1262M0_JOIN_STATUS_NOT_JOINED; // default
-  if(get_JoinStatus(status) == CommandResponse::OK){
-    if(status == SMW_SX1262M0_JOIN_STATUS_JOINED){
-      return true;
-    }
+// Check the incoming data for the boot message of the module
+//  @param (c) : the incoming byte [uint8_t]
+//  @returns true when the line with the boot message is complete [bool]
+bool SMW_SX1262M0::_parse_banner(uint8_t c){
+  // check if already found
+  if(_found){
+    return true;
   }
-  return false; // default
-}
 
-// --------------------------------------------------
+  // match the character or check the line
+  if((c > 31) && (c < 127)){
+    if(_matcher.match(c) != PATTERN_NONE){
+      _match_index = _matcher.position(); // store the end of the boot message
+    }
+  } else if((c == CHAR_CR) || (c == CHAR_LF)){
+    // check for more data after the start of the boot message (version)
+    if((_match_index > 0) && (_matcher.position() > cstrlen(PATTERNS_BANNER[0]))){
+      _found = true; // set
+    }
 
-// Join the network
-//  @returns the type of the response [CommandResponse]
-//  NOTE: the confirmation is asynchronous (<get_JoinStatus()>)
-CommandResponse SMW_SX1262M0::join(void){
-  _send_command(CMD_JOIN, CommandAction::RUN);
-  return _read_response(SMW_SX1262M0_TIMEOUT_READ);
+    // reset for the next line
+    _matcher.reset();
+    _match_index = 0;
+  }
+  return _found;
 }
 
 // --------------------------------------------------
 
-// Listen for incoming data in the P2P communication (LoRa Test)
-//  @param (timeout) : the time to wait, in [ms] [uint32_t]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::P2P_listen(uint32_t timeout, Buffer (&buffer)){
-  float rssi, snr;
-  return P2P_listen(timeout, buffer, rssi, snr);
+// Check the incoming data for the end of the reset after setting the Join Mode
+//  @param (c) : the incoming byte [uint8_t]
+//  @returns true when the marker is found [bool]
+bool SMW_SX1262M0::_parse_marker(uint8_t c){
+  return (_matcher.match(c) != PATTERN_NONE); // "AppKey" or "AppSKey"
 }
 
 // --------------------------------------------------
 
-// Listen for incoming data in the P2P communication (LoRa Test)
-//  @param (timeout) : the time to wait, in [ms] [uint32_t]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::P2P_listen(uint32_t timeout, Buffer (&buffer), float (&rssi), float (&snr)){
-  CommandResponse res = CommandResponse::OK; // default
-
-  const char *str_rssi = "RSSI=";
-  const char *str_snr = "SNR=";
-  const char *str_data = "-> ";
-  
-  uint8_t index_rssi[] = {0,0}; // { max , current }
-  index_rssi[0] = strlen(str_rssi); // separated to avoid narrowing conversion warning
-  index_rssi[0] -= 1;
-  uint8_t index_snr[] = {0,0}; // { max , current }
-  index_snr[0] = strlen(str_snr); // separated to avoid narrowing conversion warning
-  index_snr[0] -= 1;
-  uint8_t index_data[] = {0,0}; // { max , current }
-  index_data[0] = strlen(str_data); // separated to avoid narrowing conversion warning
-  index_data[0] -= 1;
-
-  // assign default values
-  rssi = 0;
-  snr = 0;
-
-  uint8_t b;
-  char str[5];
-  uint8_t index_str = 0;
-  enum { NOTHING , RSSI , SNR , DATA };
-  uint8_t store = NOTHING;
-  uint32_t stop_time = millis() + timeout;
-  while(millis() < stop_time){
-    if(_stream->available()){
-      b = _stream->read();
-      
-      // store
-      switch(store){
-        case RSSI: {
-          if((b == '-') || isdigit(b)){
-            if(index_str < 4){
-              str[index_str++] = b; // store
-            }
-          } else { // end of value
-            str[index_str] = CHAR_EOS;
-            rssi = atoi(str);
-            store = NOTHING; // reset
-          }
-          break;
-        }
-        
-        case SNR: {
-          if((b == '-') || isdigit(b)){
-            if(index_str < 4){
-              str[index_str++] = b; // store
-            }
-          } else { // end of value
-            str[index_str] = CHAR_EOS;
-            snr = atoi(str);
-            store = NOTHING; // reset
-          }
-          break;
-        }
-        
-        case DATA: {
-          if(b >= CHAR_SPACE){
-            _buffer.append(b); // store
-          } else { // end of text
-            buffer = _buffer;
-            res = CommandResponse::DATA;
-
-            // flush the data
-            while((_stream->peek() == CHAR_LF) || (_stream->peek() == CHAR_CR)){
-              _stream->read();
-            }
-
-            // exit the timing loop
-            stop_time = 0;
-          }
-          break;
-        }
-        
-        default: {
-          // do nothing
-          break;
+// Parse the incoming data in the P2P communication (LoRa Test)
+//  @param (c) : the incoming byte [uint8_t]
+//  @returns true when a message is received [bool]
+bool SMW_SX1262M0::_parse_P2P(uint8_t c){
+  const P2PField fields[] = { P2PField::RSSI , P2PField::SNR , P2PField::DATA };
+  Buffer &buffer = _p2p_target ? *_p2p_target : _buffer; // the buffer of <P2P_listen()> or the internal one
+
+  // store
+  switch(_p2p_field){
+    case P2PField::RSSI:
+    case P2PField::SNR: {
+      if((c == '-') || isdigit(c)){
+        if(_p2p_value_index < 4){
+          _p2p_value[_p2p_value_index++] = c; // store
         }
-      }
-
-      // check RSSI
-      if(store != DATA){
-        if(b == str_rssi[index_rssi[1]]){
-          // check the length
-          if(index_rssi[1] == index_rssi[0]){
-            store = RSSI;
-            index_str = 0; // reset
-          } else {
-            index_rssi[1]++; // update
-          }
+      } else { // end of value
+        _p2p_value[_p2p_value_index] = CHAR_EOS;
+        if(_p2p_field == P2PField::RSSI){
+          _p2p_rssi = atoi(_p2p_value);
         } else {
-          index_rssi[1] = 0; // reset
+          _p2p_snr = atoi(_p2p_value);
         }
+        _p2p_field = P2PField::NOTHING; // reset
       }
-      
-      // check SNR
-      if(store != DATA){
-        if(b == str_snr[index_snr[1]]){
-          // check the length
-          if(index_snr[1] == index_snr[0]){
-            store = SNR;
-            index_str = 0; // reset
-          } else {
-            index_snr[1]++; // update
-          }
-        } else {
-          index_snr[1] = 0; // reset
+      break;
+    }
+    
+    case P2PField::DATA: {
+      if(c >= CHAR_SPACE){
+        // enlarge the buffer of <P2P_listen()> (doubled, to limit the allocations)
+        if(_p2p_target && buffer.isFull() && (buffer.size() < SMW_SX1262M0_BUFFER_SIZE)){
+          buffer_size_t size = (buffer.size() < 16) ? 16 : (2 * buffer.size());
+          buffer.resize((size < SMW_SX1262M0_BUFFER_SIZE) ? size : SMW_SX1262M0_BUFFER_SIZE);
         }
-      }
-      
-      // check Data
-      if(store != DATA){
-        if(b == str_data[index_data[1]]){
-          // check the length
-          if(index_data[1] == index_data[0]){
-            store = DATA;
-            _buffer.reset(); // reset
-          } else {
-            index_data[1]++; // update
-          }
-        } else {
-          index_data[1] = 0; // reset
+        buffer.append(c); // store
+      } else { // end of text
+        // flush the data
+        while((_stream->peek() == CHAR_LF) || (_stream->peek() == CHAR_CR)){
+          _stream->read();
         }
+
+        return true;
       }
+      break;
+    }
+    
+    default: {
+      // do nothing
+      break;
     }
   }
 
-  return res;
-}
-
-// --------------------------------------------------
-
-// Start the P2P communication (LoRa Test)
-//  @param (frequency) : the frequency to use for the wireless communication, in kHz [uint32_t]
-//         (continuous) : TRUE to make the communication persistent [bool]
-//         (data) : the data to send [char *]. If this parameter is omitted, the module will enter Rx mode instead of Tx.
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::P2P_start(uint32_t frequency, bool continuous, const char *data){
-  // check the frequency
-  if((frequency < 902000) || (frequency > 927800)){
-    return CommandResponse::ERROR;
-  }
-  if((frequency > 907400) && (frequency < 915200)){
-    return CommandResponse::ERROR;
-  }
-
-  // convert the frequency
-  char sfreq[7];
-  sfreq[6] = CHAR_EOS;
-  for(int8_t i=5 ; i >=0 ; i--){
-    sfreq[i] = frequency % 10;
-    sfreq[i] += '0';
-    frequency /= 10;
+  // check the fields (all at once)
+  if(_p2p_field != P2PField::DATA){
+    uint8_t pattern = _matcher.match(c);
+    if(pattern != PATTERN_NONE){
+      _p2p_field = fields[pattern];
+      _p2p_value_index = 0; // reset
+      if(_p2p_field == P2PField::DATA){
+        buffer.reset(); // reset
+      }
+    }
   }
 
-  // convert the mode
-  char mode[2];
-  mode[0] = (continuous) ? '1' : '0';
-  mode[1] = CHAR_EOS;
-
-  // check the data
-  if(data == nullptr){
-    _send_command(CMD_LORA_RX, CommandAction::SET, 2, sfreq, mode);
-  } else {
-    _send_command(CMD_LORA_TX, CommandAction::SET, 3, sfreq, mode, data);
-  }
-  
-  return _read_response(SMW_SX1262M0_TIMEOUT_READ);
+  return false;
 }
 
 // --------------------------------------------------
 
-// Stop the P2P communication (LoRa Test)
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::P2P_stop(void){
-  // flush the serial buffer
-  // NOTE: the serial buffer might have some data because of the P2P output (for Tx and Rx).
-  if(_stream->available()){
-    _stream->read(); // read the incoming byte
+// Parse the incoming data that is not a response (URC), one byte at a time
+//  @param (c) : the incoming byte [uint8_t]
+void SMW_SX1262M0::_parse_URC(uint8_t c){
+  if((c > 31) && (c < 127)){
+    // check for a new line
+    if(!_urc_line_open){
+      _urc_line_open = true; // set
+      _urc_buffer.reset();
+    }
+
+    _urc_buffer.append(c);
+  } else if((c == CHAR_CR) || (c == CHAR_LF)){
+    // check for the end of a line
+    if(_urc_line_open){
+      _urc_line_open = false; // reset
+
+      URCType type = URCType::OTHER; // default
+      _match_URC(_urc_buffer, 0, type);
+      _dispatch_URC(type);
+    }
   }
-  
-  _send_command(CMD_LORA_OFF, CommandAction::RUN);
-  return _read_response(SMW_SX1262M0_TIMEOUT_READ);
 }
 
 // --------------------------------------------------
 
-// Ping the module
+// Read the response of a command
+//  @param (type) : the class of the timeout [TimeoutClass]
 //  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::ping(void){
-  _send_command(nullptr, CommandAction::RUN); // the command already sends "AT"
-  return _read_response(SMW_SX1262M0_TIMEOUT_READ);
+//  NOTE: the function returns as soon as the status line is received, the timeout is only an upper bound.
+CommandResponse SMW_SX1262M0::_read_response(TimeoutClass type){
+  if(!_queue_push(Phase::RESPONSE, type, nullptr)){
+    return CommandResponse::ERROR;
+  }
+  return _wait();
 }
 
 // --------------------------------------------------
 
-// Read a text message from the module
-//  @returns the type of the response [CommandResponse]
-//  NOTE: the data must be obtained from the buffer
-CommandResponse SMW_SX1262M0::readT(void){
-  // send the command and read the response
-  _send_command(CMD_RECV, CommandAction::GET);
-  return _read_response(SMW_SX1262M0_TIMEOUT_READ);
+// Record the latency of the current command in the histogram of its class
+//  @param (timeout) : true if the command timed out [bool]
+//  NOTE: the timeouts are recorded in the overflow bin. The counts are halved
+//        when a bin saturates, so the histogram follows the recent latencies.
+//        Nothing is recorded without SMW_SX1262M0_ADAPTIVE_TIMEOUT.
+void SMW_SX1262M0::_record_latency(bool timeout){
+  if(_timeout_class == TimeoutClass::NONE){
+    return; // not tracked
+  }
+#ifdef SMW_SX1262M0_ADAPTIVE_TIMEOUT
+  uint8_t *bins = _latency[static_cast<uint8_t>(_timeout_class)];
+
+  // find the bin
+  uint8_t bin = SMW_SX1262M0_LATENCY_BINS - 1; // overflow
+  if(!timeout){
+    uint32_t latency = millis() - _start_time;
+    for(uint8_t i=0 ; i < (SMW_SX1262M0_LATENCY_BINS - 1) ; i++){
+      if(latency <= latency_bound(i)){
+        bin = i;
+        break;
+      }
+    }
+  }
+
+  // update the histogram
+  if(bins[bin] == 0xFF){
+    for(uint8_t i=0 ; i < SMW_SX1262M0_LATENCY_BINS ; i++){
+      bins[i] >>= 1; // decay
+    }
+  }
+  bins[bin]++;
+#else
+  (void)timeout; // unused
+#endif
+  _timeout_class = TimeoutClass::NONE; // record only once
 }
 
 // --------------------------------------------------
 
-// Read a text message from the module
-//  @param (buffer) : the buffer to store the payload [Buffer (&)]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::readT(Buffer (&buffer)){
-  uint8_t port;
-  return readT(port, buffer);
+// Match the current line with the status codes, one byte at a time
+//  @param (c) : the incoming byte [uint8_t]
+//  NOTE: the codes are walked in table order, so each byte is compared with
+//        the candidates only once (single pass over the line).
+void SMW_SX1262M0::_match_status(uint8_t c){
+  while(_status_index < STATUS_CODES_QTY){
+    const StatusCode code = progmem_read(STATUS_CODES[_status_index]);
+    if((_status_length < code.length) && (code.text[_status_length] == c)){
+      _status_length++; // update
+      return;
+    }
+
+    // go to the next code with the same prefix
+    _status_index++;
+    if((_status_index < STATUS_CODES_QTY) && (progmem_read(STATUS_CODES[_status_index].prefix) < _status_length)){
+      _status_index = STATUS_CODES_QTY; // no match
+    }
+  }
 }
 
 // --------------------------------------------------
 
-// Read a text message from the module
-//  @param (port) : the application port [uint8_t (&)]
-//         (buffer) : the buffer to store the payload [Buffer (&)]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::readT(uint8_t (&port), Buffer (&buffer)){
-  CommandResponse res = readT(); // read the message
-
-  // parse the message
-  uint8_t b;
-  bool payload = false;
-  char sport[4]; // 0 to 999
-  uint8_t index = 0;
-  while (_buffer.available()){
-    b = _buffer.read();
-
-    // check for delimitter
-    if(b == CHAR_COLON){
-      payload = true; // set
-      buffer.resize(_buffer.available()); // resize the buffer
+// Check if a line is an unsolicited result code (URC)
+//  @param (buffer) : the buffer with the line [Buffer (&)]
+//         (start) : the index of the line in the buffer [buffer_size_t]
+//         (type) : the variable to store the type of the URC [URCType (&)]
+//  @returns true if the line starts with a known URC [bool]
+bool SMW_SX1262M0::_match_URC(Buffer (&buffer), buffer_size_t start, URCType (&type)){
+  buffer_size_t length = buffer.available() - start;
+  for(uint8_t i=0 ; i < URC_CODES_QTY ; i++){
+    const URCCode code = progmem_read(URC_CODES[i]);
+    if(code.length > length){
       continue;
     }
 
-    // parse
-    if(!payload){
-      if((index < 3) && isdigit(b)){
-        sport[index++] = b;
-        sport[index] = CHAR_EOS;
-      }
-    } else {
-      buffer.append(b);
+    // compare the prefix
+    uint8_t j = 0;
+    while((j < code.length) && (buffer[start + j] == code.text[j])){
+      j++;
+    }
+    if(j == code.length){
+      type = code.type;
+      return true;
     }
   }
-  port = atoi(sport); // convert
 
-  return res;
+  return false;
 }
 
 // --------------------------------------------------
 
-// Read an hexadecimal message from the module
-//  @returns the type of the response [CommandResponse]
-//  NOTE: the data must be obtained from the buffer
-CommandResponse SMW_SX1262M0::readX(void){
-  // send the command and read the response
-  _send_command(CMD_RECVB, CommandAction::GET);
-  return _read_response(SMW_SX1262M0_TIMEOUT_READ);
-}
-// --------------------------------------------------
+// Split the response in data and status, one byte at a time
+//  @param (c) : the incoming byte [uint8_t]
+//         (response) : the variable to store the type of the response [CommandResponse (&)]
+//  @returns true when the status line is complete [bool]
+//  NOTE: the lines of data are stored in the buffer separated by a single <LF>, without the
+//        leading and trailing line terminators. The status line is removed from the buffer.
+bool SMW_SX1262M0::_tokenize(uint8_t c, CommandResponse (&response)){
+  if((c > 31) && (c < 127)){
+    // check for a new line
+    if(!_line_open){
+      _line_open = true; // set
+      _data_length = _buffer.available(); // the data received before this line
+      if(_data_length > 0){
+        _buffer.append(CHAR_LF); // separate from the previous line
+        _rx_parsing = false; // the port is only in the first line
+      }
+      _line_start = _buffer.available();
 
-// Read an hexadecimal message from the module
-//  @param (buffer) : the buffer to store the payload [Buffer (&)]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::readX(Buffer (&buffer)){
-  uint8_t port;
-  return readX(port, buffer);
-}
+      // reset the status matcher
+      _status_index = 0;
+      _status_length = 0;
+    }
 
-// --------------------------------------------------
+    _buffer.append(c);
+    _match_status(c);
 
-// Read an hexadecimal message from the module
-//  @param (port) : the application port [uint8_t (&)]
-//         (buffer) : the buffer to store the payload [Buffer (&)]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::readX(uint8_t (&port), Buffer (&buffer)){
-  CommandResponse res = readX(); // read the message
+    // parse the port of a downlink ("port:payload")
+    if(_rx_parsing){
+      if(isdigit(c)){
+        _rx_port = (_rx_port * 10) + (c - '0');
+      } else {
+        _rx_parsing = false; // done
+        if(c == CHAR_COLON){
+          _rx_valid = true; // set
+          _rx_offset = _buffer.available();
+        }
+      }
+    }
+  } else if((c == CHAR_CR) || (c == CHAR_LF)){
+    // check for the end of a line
+    if(_line_open){
+      _line_open = false; // reset
+
+      // check for a complete status code
+      if((_status_index < STATUS_CODES_QTY) && (_status_length == progmem_read(STATUS_CODES[_status_index].length))){
+        response = progmem_read(STATUS_CODES[_status_index].response);
+        _buffer.truncate(_data_length); // keep only the data
+        return true;
+      }
 
-  // parse the message
-  uint8_t b;
-  bool payload = false;
-  char sport[4]; // 0 to 999
-  uint8_t index = 0;
-  while (_buffer.available()){
-    b = _buffer.read();
+      // check for an unsolicited result code in the response
+      URCType type;
+      if(_match_URC(_buffer, _line_start, type)){
+        _urc_buffer.reset();
+        for(buffer_size_t i=_line_start ; i < _buffer.available() ; i++){
+          _urc_buffer.append(_buffer[i]);
+        }
+        _buffer.truncate(_data_length); // keep only the data
 
-    // check for delimitter
-    if(b == CHAR_COLON){
-      payload = true; // set
-      buffer.resize(_buffer.available()); // resize the buffer
-      continue;
-    }
+        // parse the port again in the next line (if the notification was the first line)
+        if(_data_length == 0){
+          _rx_parsing = (_phase == Phase::RECEIVE);
+          _rx_port = 0; // reset
+        }
 
-    // parse
-    if(!payload){
-      if((index < 3) && isdigit(b)){
-        sport[index++] = b;
-        sport[index] = CHAR_EOS;
+        _dispatch_URC(type);
       }
-    } else {
-      buffer.append(b);
     }
   }
-  port = atoi(sport); // convert
 
-  return res;
+  return false;
 }
 
 // --------------------------------------------------
 
-// Reset the module
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::reset(void){
-  // do a software reset
-#ifdef SMW_SX1262M0_DEBUG
-  if(_stream_debug){
-    _stream_debug->write('[');
-    _stream_debug->write(CMD_RESET);
-    _stream_debug->write(']');
-  }
-#endif
-  _stream->write(CMD_RESET);
-  _stream->write(CHAR_CR);
-
-//  _reset = false; // reset
-  CommandResponse res = CommandResponse::ERROR; // default
+// Build a command in the current frame
+//  @param (command) : the command to send [char *]
+//         (action)  : the type of action for the command [CommandAction]
+//         (qty)     : the quantity of other parameters to send [uint8_t]
+//         (arg_list) : the list of data to send [va_list]
+//  NOTE: the command is built in a buffer on the stack and written at once
+//        (longer commands are written in chunks of SMW_SX1262M0_FRAME_SIZE).
+void SMW_SX1262M0::_build_command(const char *command, CommandAction action, uint8_t qty, va_list arg_list){
+  char frame[SMW_SX1262M0_FRAME_SIZE];
+  uint8_t length = 0;
+
+  _frame_begin();
   
-  // read the incoming data
-  uint8_t c;
-  const char* const STR_TO_FIND = "ATtention";
-  uint32_t stop_time = millis() + SMW_SX1262M0_TIMEOUT_RESET;
-  while(millis() < stop_time){
-    if(_stream->available()){
-      c = _stream->read(); // read the incoming byte
-      
-#ifdef SMW_SX1262M0_DEBUG
-      // debug
-      if(_stream_debug){
-        if(c > 32){
-          _stream_debug->write(c);
-        } else {
-          _stream_debug->print('(');
-          _stream_debug->print(c, HEX);
-          _stream_debug->print(')');
-        }
+  // check if there is another command
+  if(command){
+    char cmd_action[] = {0,0,0}; // EOS included
+    switch(action){
+      case CommandAction::RUN: {
+        // nothing to do
+        break;
       }
-#endif
 
-      // check if already found
-      if(res != CommandResponse::OK){
-        // append the character or seach the string
-        if((c > 31) && (c < 127)){
-          _buffer.append(c);
-        } else if((c == CHAR_CR) || (c == CHAR_LF)){
-            // get a copy of the buffer
-            uint8_t data_length = _buffer.available();
-            uint8_t data[data_length];
-            _buffer.copy(data);
-            
-            // search for the string
-            void *ptr = memmem(data, data_length, STR_TO_FIND, strlen(STR_TO_FIND));
-            if(ptr){
-              if(data_length > strlen(STR_TO_FIND)){
-                res = CommandResponse::OK; // set
-              }
-            }
-
-            _buffer.reset(); // reset the buffer
-        }
+      case CommandAction::GET: {
+        cmd_action[0] = CHAR_EQUAL;
+        cmd_action[1] = CHAR_QUESTION;
+        break;
+      }
+
+      case CommandAction::SET: {
+        cmd_action[0] = CHAR_EQUAL;
+        break;
+      }
+
+      case CommandAction::HELP:
+      default: {
+        cmd_action[0] = CHAR_QUESTION;
+        break;
+      }
+    }
+    length = _frame_append(frame, length, FRAME_PREFIX); // add the <AT+> prefix
+    length = _frame_append(frame, length, command);
+    length = _frame_append(frame, length, cmd_action);
+
+    // add the parameters
+    const char separator[] = {CHAR_COLON, CHAR_EOS};
+    for(uint8_t i=0 ; i < qty ; i++){
+      length = _frame_append(frame, length, va_arg(arg_list, char *));
+
+      // add the separator if necessary
+      if(i < (qty - 1)){
+        length = _frame_append(frame, length, separator);
       }
-      
-    } else {
-      _delay(SMW_SX1262M0_DELAY_INCOMING_DATA); // give some time for data to arrive
     }
+  } else {
+    length = _frame_append(frame, length, CMD_AT); // only the <AT> prefix
   }
 
-  return res;
+  const char terminator[] = {CHAR_CR, CHAR_EOS};
+  length = _frame_append(frame, length, terminator);
+  _frame_write(frame, length);
+  _frame_end();
 }
 
 // --------------------------------------------------
 
-// Save the current configuration
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::save(void){
-  _send_command(CMD_SAVE, CommandAction::RUN);
-  return _read_response(SMW_SX1262M0_TIMEOUT_WRITE); // this command takes some time to reply
+// Append a string to a frame being built
+//  @param (frame) : the buffer of the frame [char *]
+//         (length) : the current length of the frame [uint8_t]
+//         (str) : the string to append [char *]
+//  @returns the new length of the frame [uint8_t]
+//  NOTE: the buffer is written to the current frame when it is full.
+uint8_t SMW_SX1262M0::_frame_append(char (&frame)[SMW_SX1262M0_FRAME_SIZE], uint8_t length, const char *str){
+  while(*str != CHAR_EOS){
+    if(length == SMW_SX1262M0_FRAME_SIZE){
+      _frame_write(frame, length);
+      length = 0; // reset
+    }
+    frame[length++] = *str++;
+  }
+
+  return length;
 }
 
 // --------------------------------------------------
 
-// Send a text message
-//  @param (port) : the application port [uint8_t]
-//         (data) : the text data to send [char *]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::sendT(uint8_t port, const char *data){
-  // parse the port
-  uint8_t aport = port; // auxiliary variable for <port>
-  uint8_t temp[3];
-  temp[0] = aport / 100;
-  aport %= 100;
-  temp[1] = aport / 10;
-  temp[2] = aport % 10;
+// Append binary data to a frame, as hexadecimal
+//  @param (frame) : the buffer of the frame [char *]
+//         (length) : the current length of the frame [uint8_t]
+//         (data) : the bytes to append [uint8_t *]
+//         (size) : the number of bytes [size_t]
+//  @returns the new length of the frame [uint8_t]
+//  NOTE: the frame is written when full.
+uint8_t SMW_SX1262M0::_frame_append(char (&frame)[SMW_SX1262M0_FRAME_SIZE], uint8_t length, const uint8_t *data, size_t size){
+  while(size > 0){
+    if((length + 2) > SMW_SX1262M0_FRAME_SIZE){
+      _frame_write(frame, length);
+      length = 0; // reset
+    }
 
-  // set the header (port)
-  char sport[4]; // port stringified (0 to 999)
-  uint8_t index = 0;
-  aport = 0; // reset
-  for(uint8_t i=0 ; i < 3 ; i++){
-    if((temp[i] > 0) || (aport > 0)){
-      sport[index++] = temp[i] + '0'; // convert to ASCII character
+    // encode as many bytes as possible
+    size_t count = (SMW_SX1262M0_FRAME_SIZE - length) / 2;
+    if(count > size){
+      count = size;
     }
-    aport += temp[i]; // update (simple)
+    hex_encode(frame + length, data, count);
+    length += count * 2;
+    data += count;
+    size -= count;
   }
-  sport[index] = CHAR_EOS;
-  
-  // send the command and read the response
-  _send_command(CMD_SEND, CommandAction::SET, 2, sport, data);
-  return _read_response(SMW_SX1262M0_TIMEOUT_WRITE); // this command takes some time to reply
+
+  return length;
 }
 
 // --------------------------------------------------
 
-// Send a text message
-//  @param (port) : the application port [uint8_t]
-//         (data) : the text data to send [String]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::sendT(uint8_t port, const String data){
-  uint8_t length = data.length() + 1;
-  char cdata[length]; // create a temporary string
-  data.toCharArray(cdata, length); // copy the data (with automatic EOS)
-  return sendT(port, cdata);
+// Start a new frame
+//  @param (send) : false if there is no data to send [bool] (default: true)
+//  NOTE: the frame is sent directly when the queue is empty, otherwise it is stored in the queue.
+void SMW_SX1262M0::_frame_begin(bool send){
+  _frame_direct = (_queue_count == 0);
+  _frame_length = 0;
+  _frame_overflow = false;
+
+  if(_frame_direct && send){
+    flush(); // flush the data before sendig the command
+    // (it could be done in <readResponse()>, but it might flush some data in some cases - not verified)
+
+#ifdef SMW_SX1262M0_DEBUG
+    if(_stream_debug){
+      _stream_debug->write('[');
+    }
+#endif
+  }
 }
 
 // --------------------------------------------------
 
-// Send an hexadecimal message
-//  @param (port) : the application port [uint8_t]
-//         (data) : the text data to send [char *]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::sendX(uint8_t port, const char *data){
-  // parse the port
-  uint8_t aport = port; // auxiliary variable for <port>
-  uint8_t temp[3];
-  temp[0] = aport / 100;
-  aport %= 100;
-  temp[1] = aport / 10;
-  temp[2] = aport % 10;
-
-  // set the header (port)
-  uint8_t sport[4]; // port stringified (0 to 999)
-  uint8_t index = 0;
-  aport = 0; // reset
-  for(uint8_t i=0 ; i < 3 ; i++){
-    if((temp[i] > 0) || (aport > 0)){
-      sport[index++] = temp[i] + '0'; // convert to ASCII character
-    }
-    aport += temp[i]; // update (simple)
+// End the current frame
+void SMW_SX1262M0::_frame_end(void){
+#ifdef SMW_SX1262M0_DEBUG
+  if(_frame_direct && _stream_debug){
+    _stream_debug->write(']');
   }
-  sport[index] = CHAR_EOS;
-  
-  // send the command and read the response
-  _send_command(CMD_SENDB, CommandAction::SET, 2, sport, data);
-  return _read_response(SMW_SX1262M0_TIMEOUT_WRITE); // this command takes some time to reply
+#endif
 }
 
 // --------------------------------------------------
 
-// Send an hexadecimal message
-//  @param (port) : the application port [uint8_t]
-//         (data) : the text data to send [String]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::sendX(uint8_t port, const String data){
-  uint8_t length = data.length() + 1;
-  char cdata[length]; // create a temporary string
-  data.toCharArray(cdata, length); // copy the data (with automatic EOS)
-  return sendX(port, cdata);
+// Write data to the current frame
+//  @param (data) : the data to write [char *]
+//         (length) : the length of the data [uint8_t]
+void SMW_SX1262M0::_frame_write(const char *data, uint8_t length){
+  if(_frame_direct){
+#ifdef SMW_SX1262M0_DEBUG
+    if(_stream_debug){
+      _stream_debug->write(data, length);
+    }
+#endif
+    _stream->write(data, length);
+  } else if(length <= (SMW_SX1262M0_QUEUE_BUFFER_SIZE - _queue_data_count - _frame_length)){
+    // copy the data in up to two segments of the ring
+    uint8_t index = (_queue_data_tail + _frame_length) % SMW_SX1262M0_QUEUE_BUFFER_SIZE;
+    uint8_t segment = SMW_SX1262M0_QUEUE_BUFFER_SIZE - index;
+    if(segment > length){
+      segment = length;
+    }
+    memcpy(&_queue_data[index], data, segment);
+    memcpy(_queue_data, data + segment, length - segment);
+    _frame_length += length; // update
+  } else {
+    _frame_overflow = true; // set
+  }
 }
 
 // --------------------------------------------------
 
-// Set the Adaptive Data Rate
-//  @param (adr) : the data to be sent [uint8_t]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::set_ADR(uint8_t adr){
-  adr = (adr == SMW_SX1262M0_ADR_ON) ? SMW_SX1262M0_ADR_ON : SMW_SX1262M0_ADR_OFF; // force binary value
-  adr += '0'; // convert to ASCII character, without a narrowing conversion
-  unsigned char data[] = { adr , CHAR_EOS};
-  
-  // send the command and read the response
-  _send_command(CMD_ADR, CommandAction::SET, 1, data);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_WRITE); // this command takes almost X s to reply
+// Send the queued commands to the module
+//  NOTE: up to SMW_SX1262M0_QUEUE_IN_FLIGHT commands are sent before the first response,
+//        except for the commands that reset the module or that don't have a response (barrier).
+void SMW_SX1262M0::_pump(void){
+  while(_queue_sent < _queue_count){
+    QueueEntry &entry = _queue[(_queue_head + _queue_sent) % SMW_SX1262M0_QUEUE_SIZE];
 
-  return res;
+    // check the limits
+    if(_queue_sent >= SMW_SX1262M0_QUEUE_IN_FLIGHT){
+      break;
+    }
+    if((_queue_sent > 0) && (entry.barrier || _queue[_queue_head].barrier)){
+      break; // a barrier is sent alone
+    }
+
+    // send the frame
+    if(entry.length > 0){
+      if(_queue_sent == 0){
+        flush(); // flush the data before sendig the command
+      }
+
+#ifdef SMW_SX1262M0_DEBUG
+      if(_stream_debug){
+        _stream_debug->write('[');
+      }
+#endif
+      // write the frame in up to two segments of the ring
+      uint8_t remaining = entry.length;
+      while(remaining > 0){
+        uint8_t segment = SMW_SX1262M0_QUEUE_BUFFER_SIZE - _queue_data_head;
+        if(segment > remaining){
+          segment = remaining;
+        }
+#ifdef SMW_SX1262M0_DEBUG
+        if(_stream_debug){
+          _stream_debug->write(&_queue_data[_queue_data_head], segment);
+        }
+#endif
+        _stream->write(&_queue_data[_queue_data_head], segment);
+        _queue_data_head = (_queue_data_head + segment) % SMW_SX1262M0_QUEUE_BUFFER_SIZE;
+        remaining -= segment;
+      }
+      _queue_data_count -= entry.length;
+#ifdef SMW_SX1262M0_DEBUG
+      if(_stream_debug){
+        _stream_debug->write(']');
+      }
+#endif
+    }
+
+    _queue_sent++; // update
+  }
+
+  // wait for the response of the oldest command
+  if((_phase == Phase::NONE) && (_queue_sent > 0)){
+    QueueEntry &entry = _queue[_queue_head];
+    _begin(entry.phase, entry.type, entry.timeout, entry.callback);
+  }
 }
 
 // --------------------------------------------------
 
-// Set the Automatic Join
-//  @param (ajoin) : the data to be sent [uint8_t]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::set_AJoin(uint8_t ajoin){
-  ajoin = (ajoin == SMW_SX1262M0_AUTOMATIC_JOIN_ON) ? SMW_SX1262M0_AUTOMATIC_JOIN_ON : SMW_SX1262M0_AUTOMATIC_JOIN_OFF; // force binary value
-  ajoin += '0'; // convert to ASCII character, without a narrowing conversion
-  unsigned char data[] = { ajoin , CHAR_EOS};
-  
-  // send the command and read the response
-  _send_command(CMD_AJOIN, CommandAction::SET, 1, data);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_WRITE); // this command takes almost X s to reply
+// Queue a command to the module
+//  @param (command) : the command to send [char *]
+//         (action)  : the type of action for the command [CommandAction]
+//         (qty)     : the quantity of other parameters to send [uint8_t]
+//         (...)     : optional and variable data to send [char *]
+//  NOTE: must be followed by <_queue_push()>.
+void SMW_SX1262M0::_queue_command(const char *command, CommandAction action, uint8_t qty, ...){
+  va_list arg_list;
+  va_start(arg_list, qty);
+  _build_command(command, action, qty, arg_list);
+  va_end(arg_list);
+}
 
-  return res;
+// --------------------------------------------------
+
+// Queue a frame generated at compile time
+//  @param (frame) : the data of the frame [char *]
+//         (length) : the length of the frame [uint8_t]
+//  NOTE: must be followed by <_queue_push()>. On AVR, the frame is read from
+//        the flash (SMW_SX1262M0_PROGMEM).
+void SMW_SX1262M0::_queue_frame(const char *frame, uint8_t length){
+  _frame_begin();
+#if defined(__AVR__)
+  for(uint8_t i=0 ; i < length ; i++){
+    char c = pgm_read_byte(&frame[i]);
+    _frame_write(&c, 1);
+  }
+#else
+  _frame_write(frame, length);
+#endif
+  _frame_end();
 }
 
 // --------------------------------------------------
 
-// Set the Application EUI
-//  @param (appeui) : the array with the data to be sent [char *]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::set_AppEUI(const char *appeui){
-  // filter the data
-  uint8_t length = SMW_SX1262M0_SIZE_APPEUI + 8; // +1 for EOS and +7 for ':'
-  char str[length];
-  str[length - 1] = CHAR_EOS;
-  filter_string(str, SMW_SX1262M0_SIZE_APPEUI, appeui, FILTER_HEX);
-
-  // format the string ("xx:xx:xx:xx:xx:xx:xx:xx")
-  for(uint8_t i=2 ; i < (length - 1) ; i += 3){ // ignore EOS
-    // shift the data (start from the end)
-    for(uint8_t j=(length - 2) ; j > i ; j--){ // ignore EOS
-      str[j] = str[j-1];
-    }
+// Add the current frame to the queue
+//  @param (phase) : the phase of the response [Phase]
+//         (type) : the class of the timeout [TimeoutClass]
+//         (callback) : the function to call on completion [CommandCallback]
+//         (barrier) : true if no other command can be sent until the response [bool] (default: false)
+//         (timeout) : the time to wait for the response in miliseconds, for the NONE class [uint32_t] (default: 0)
+//  @returns true if the command was queued [bool]
+//  NOTE: the timeout starts when the previous command is completed.
+bool SMW_SX1262M0::_queue_push(Phase phase, TimeoutClass type, CommandCallback callback, bool barrier, uint32_t timeout){
+  // check the space (the frame data is discarded)
+  if(_frame_overflow || (_queue_count >= SMW_SX1262M0_QUEUE_SIZE)){
+    return false;
+  }
 
-    str[i] = CHAR_COLON; // insert the colon
+  // store the command
+  QueueEntry &entry = _queue[(_queue_head + _queue_count) % SMW_SX1262M0_QUEUE_SIZE];
+  entry.callback = callback;
+  entry.timeout = timeout;
+  entry.length = _frame_direct ? 0 : _frame_length;
+  entry.phase = phase;
+  entry.type = type;
+  entry.barrier = barrier;
+  entry.confirm = false; // default (see <_confirm_update()>)
+  entry.apply = false; // default (see <_apply_step()>)
+  entry.spool = false; // default (see <_spool_update()>)
+  _queue_count++;
+
+  // update the data
+  if(_frame_direct){
+    _queue_sent++; // already sent
+  } else {
+    _queue_data_tail = (_queue_data_tail + _frame_length) % SMW_SX1262M0_QUEUE_BUFFER_SIZE;
+    _queue_data_count += _frame_length;
   }
-  
-  // send the command and read the response
-  _send_command(CMD_APPEUI, CommandAction::SET, 1, str);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_WRITE); // this command takes almost X s to reply
 
-  return res;
+  _pump();
+  return true;
 }
 
 // --------------------------------------------------
 
-// Set the Application Key
-//  @param (appkey) : the array with the data to be sent [char *]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::set_AppKey(const char *appkey){
-  // filter the data
-  uint8_t length = SMW_SX1262M0_SIZE_APPKEY + 16; // +1 for EOS and +15 for ':'
-  char str[length];
-  str[length - 1] = CHAR_EOS;
-  filter_string(str, SMW_SX1262M0_SIZE_APPKEY, appkey, FILTER_HEX);
-
-  // format the string ("xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx")
-  for(uint8_t i=2 ; i < (length - 1) ; i += 3){ // ignore EOS
-    // shift the data (start from the end)
-    for(uint8_t j=(length - 2) ; j > i ; j--){ // ignore EOS
-      str[j] = str[j-1];
-    }
-
-    str[i] = CHAR_COLON; // insert the colon
+// Queue an uplink and record its time on air
+//  @param (length) : the length of the payload [bytes]
+//         (callback) : the function to call on completion [CommandCallback]
+//  @returns true if the command was queued [bool]
+//  NOTE: must be preceded by the frame of the uplink.
+bool SMW_SX1262M0::_push_uplink(size_t length, CommandCallback callback){
+  if(!_queue_push(Phase::RESPONSE, TimeoutClass::SEND, callback)){
+    return false;
   }
-  
-  // send the command and read the response
-  _send_command(CMD_APPKEY, CommandAction::SET, 1, str);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_WRITE); // this command takes almost X s to reply
-
-  return res;
+  _scheduler.record(millis(), _data_rate, (length > 0xFF) ? 0xFF : length);
+  return true;
 }
 
 // --------------------------------------------------
 
-// Set the Application Session Key
-//  @param (appskey) : the array with the data to be sent [char *]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::set_AppSKey(const char *appskey){
-  // filter the data
-  uint8_t length = SMW_SX1262M0_SIZE_APPSKEY + 16; // +1 for EOS and +15 for ':'
-  char str[length];
-  str[length - 1] = CHAR_EOS;
-  filter_string(str, SMW_SX1262M0_SIZE_APPSKEY, appskey, FILTER_HEX);
+// Send a command to the module
+//  @param (command) : the command to send [char *]
+//         (action)  : the type of action for the command [CommandAction]
+//         (qty)     : the quantity of other parameters to send [uint8_t]
+//         (...)     : optional and variable data to send [char *]
+//  NOTE: the pending commands are completed before sending this one. Must be followed by <_read_response()>.
+void SMW_SX1262M0::_send_command(const char *command, CommandAction action, uint8_t qty, ...){
+  _wait(); // finish the pending commands
 
-  // format the string ("xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx")
-  for(uint8_t i=2 ; i < (length - 1) ; i += 3){ // ignore EOS
-    // shift the data (start from the end)
-    for(uint8_t j=(length - 2) ; j > i ; j--){ // ignore EOS
-      str[j] = str[j-1];
-    }
+  va_list arg_list;
+  va_start(arg_list, qty);
+  _build_command(command, action, qty, arg_list);
+  va_end(arg_list);
+}
 
-    str[i] = CHAR_COLON; // insert the colon
-  }
-  
-  // send the command and read the response
-  _send_command(CMD_APPSKEY, CommandAction::SET, 1, str);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_WRITE); // this command takes almost X s to reply
+// --------------------------------------------------
 
-  return res;
+// Send a frame generated at compile time
+//  @param (frame) : the data of the frame [char *]
+//         (length) : the length of the frame [uint8_t]
+//  NOTE: the pending commands are completed before sending this one. Must be followed by <_read_response()>.
+void SMW_SX1262M0::_send_frame(const char *frame, uint8_t length){
+  _wait(); // finish the pending commands
+  _queue_frame(frame, length);
 }
 
 // --------------------------------------------------
 
-// Set the debugger of the object
-//  @param (debugger) : the stream to print to [Stream *]
-#ifdef SMW_SX1262M0_DEBUG
-void SMW_SX1262M0::set_debugger(Stream *debugger){
-  _stream_debug = debugger;
+// Complete the uplink of the spool
+//  @param (response) : the type of the response [CommandResponse]
+void SMW_SX1262M0::_spool_complete(CommandResponse response){
+  _spool_sending = false; // reset
+  if(_spool == nullptr){
+    return;
+  }
+
+  if((response == CommandResponse::NO_NETWORK) || (response == CommandResponse::BUSY)){
+    _spool_time = millis() + SMW_SX1262M0_SPOOL_RETRY; // try again later
+  } else {
+    _spool->pop(); // sent or rejected by the module
+    _spool_time = millis();
+  }
 }
-#endif
 
 // --------------------------------------------------
 
-// Set the Device Address
-//  @param (devaddr) : the array with the data to be sent [char *]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::set_DevAddr(const char *devaddr){
-  // filter the data
-  uint8_t length = SMW_SX1262M0_SIZE_DEVADDR + 4; // +1 for EOS and +3 for ':'
-  char str[length];
-  str[length - 1] = CHAR_EOS;
-  filter_string(str, SMW_SX1262M0_SIZE_DEVADDR, devaddr, FILTER_HEX);
+// Store an uplink in the spool
+//  @param (port) : the application port [uint8_t]
+//         (data) : the bytes of the uplink [uint8_t *]
+//         (length) : the number of bytes [size_t]
+//         (response) : the response of the uplink [CommandResponse]
+//  NOTE: only the uplinks that returned NO_NETWORK or BUSY are stored.
+void SMW_SX1262M0::_spool_store(uint8_t port, const uint8_t *data, size_t length, CommandResponse response){
+  _spooled = false; // reset
+  if(_spool == nullptr){
+    return;
+  }
 
-  // format the string ("xx:xx:xx:xx")
-  for(uint8_t i=2 ; i < (length - 1) ; i += 3){ // ignore EOS
-    // shift the data (start from the end)
-    for(uint8_t j=(length - 2) ; j > i ; j--){ // ignore EOS
-      str[j] = str[j-1];
+  if(response == CommandResponse::OK){
+    _spool_time = millis(); // the network is available
+  } else if((response == CommandResponse::NO_NETWORK) || (response == CommandResponse::BUSY)){
+    if(length <= SPOOL_RECORD_SIZE){
+      _spooled = _spool->push(port, data, length);
+    }
+    if(response == CommandResponse::NO_NETWORK){
+      _spool_time = millis() + SMW_SX1262M0_SPOOL_RETRY;
     }
-
-    str[i] = CHAR_COLON; // insert the colon
   }
-  
-  // send the command and read the response
-  _send_command(CMD_DADDR, CommandAction::SET, 1, str);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_WRITE); // this command takes almost X s to reply
-
-  return res;
 }
 
 // --------------------------------------------------
 
-// Set the Data Rate
-//  @param (dr) : the data to be sent [uint8_t]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::set_DR(uint8_t dr){
-  // check the value
-  if(dr > 6){
-    return CommandResponse::ERROR;
+// Store an hexadecimal uplink in the spool
+//  @param (port) : the application port [uint8_t]
+//         (data) : the hexadecimal text of the uplink [char *]
+//         (length) : the length of the text [size_t]
+//         (response) : the response of the uplink [CommandResponse]
+void SMW_SX1262M0::_spool_store(uint8_t port, const char *data, size_t length, CommandResponse response){
+  uint8_t bytes[SPOOL_RECORD_SIZE];
+  size_t count = 0;
+  if((_spool != nullptr) && ((response == CommandResponse::NO_NETWORK) || (response == CommandResponse::BUSY))){
+    count = hex_decode(bytes, sizeof(bytes), data, length);
+    if((count * 2) != length){
+      response = CommandResponse::PARAM_ERROR; // not stored (invalid text or too long)
+    }
   }
-
-  dr += '0'; // convert to ASCII character, without a narrowing conversion
-  unsigned char data[] = { dr , CHAR_EOS};
-  
-  // send the command and read the response
-  _send_command(CMD_DR, CommandAction::SET, 1, data);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_WRITE); // this command takes almost X s to reply
-
-  return res;
+  _spool_store(port, bytes, count, response);
 }
 
 // --------------------------------------------------
 
-// Set the Join Mode
-//  @param (mode) : the data to be sent [uint8_t]
-//  @returns the type of the response [CommandResponse]
-//  NOTE: this command resets the module, but returns "OK" after completion
-CommandResponse SMW_SX1262M0::set_JoinMode(uint8_t mode){
-  // check the value
-  if(mode > SMW_SX1262M0_JOIN_MODE_OTAA){
-    return CommandResponse::ERROR;
+// Send the oldest uplink of the spool
+//  NOTE: called by <poll()> when there are no pending commands.
+void SMW_SX1262M0::_spool_update(void){
+  if(_spool == nullptr){
+    return;
+  }
+  _spool->commit(); // commit the delayed changes (if any)
+  if(_spool_sending || (_spool->count() == 0)){
+    return;
+  }
+  if(static_cast<int32_t>(millis() - _spool_time) < 0){
+    return; // not yet
   }
 
-  mode += '0'; // convert to ASCII character, without a narrowing conversion
-  unsigned char data[] = { mode , CHAR_EOS};
-  
-  // send the command and read the response
-  _send_command(CMD_NJM, CommandAction::SET, 1, data);
-  
-  // read the incoming data
-  char c;
-  const char* const STR_TO_FIND = "AppKey";
-  uint8_t index = 0;
-  uint8_t length = strlen(STR_TO_FIND);
-  uint32_t stop_time = millis() + SMW_SX1262M0_TIMEOUT_RESET;
-  while(millis() < stop_time){
-    if(_stream->available()){
-      c = _stream->read(); // read the incoming byte
-      
-#ifdef SMW_SX1262M0_DEBUG
-      // debug
-      if(_stream_debug){
-        if(c > 32){
-          _stream_debug->write(c);
-        } else {
-          _stream_debug->print('(');
-          _stream_debug->print(c, HEX);
-          _stream_debug->print(')');
-        }
-      }
-#endif
+  uint8_t port;
+  uint8_t data[SPOOL_RECORD_SIZE];
+  uint8_t length = sizeof(data);
+  if(!_spool->peek(port, data, length)){
+    _spool->pop(); // invalid record
+    return;
+  }
 
-      if(c == STR_TO_FIND[index]){
-        index++; // update
+  // check the scheduler
+  CommandResponse res = _check_uplink(length);
+  if(res == CommandResponse::PARAM_OVERFLOW){
+    _spool->pop(); // can't be sent (see <get_max_payload()>)
+    return;
+  } else if(res != CommandResponse::OK){
+    return; // try again later
+  }
 
-        // check for completion
-        if(index >= length){
-          break;
-        }
-      } else if((c == 'S') && (index == 3)){ // "AppKey" vs. "AppSKey"
-        continue;
-      } else {
-        index = 0; // reset
-      }
-      
-    } else {
-      _delay(SMW_SX1262M0_DELAY_INCOMING_DATA); // give some time for data to arrive
-    }
+  // send the uplink
+  if(begin_sendX(port, data, length)){
+    _queue[(_queue_head + _queue_count - 1) % SMW_SX1262M0_QUEUE_SIZE].spool = true;
+    _spool_sending = true;
   }
-  
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_WRITE); // this command takes almost X s to reply
-  return res;
 }
 
 // --------------------------------------------------
 
-// Set the Network Session Key
-//  @param (nwkskey) : the array with the data to be sent [char *]
+// Wait for the pending command to complete
 //  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::set_NwkSKey(const char *nwkskey){
-  // filter the data
-  uint8_t length = SMW_SX1262M0_SIZE_NWKSKEY + 16; // +1 for EOS and +15 for ':'
-  char str[length];
-  str[length - 1] = CHAR_EOS;
-  filter_string(str, SMW_SX1262M0_SIZE_NWKSKEY, nwkskey, FILTER_HEX);
-
-  // format the string ("xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx:xx")
-  for(uint8_t i=2 ; i < (length - 1) ; i += 3){ // ignore EOS
-    // shift the data (start from the end)
-    for(uint8_t j=(length - 2) ; j > i ; j--){ // ignore EOS
-      str[j] = str[j-1];
-    }
-
-    str[i] = CHAR_COLON; // insert the colon
+CommandResponse SMW_SX1262M0::_wait(void){
+  while(busy()){
+    poll();
   }
-  
-  // send the command and read the response
-  _send_command(CMD_NWKSKEY, CommandAction::SET, 1, str);
-  CommandResponse res = _read_response(SMW_SX1262M0_TIMEOUT_WRITE); // this command takes some time to reply
 
-  return res;
+  return _response;
 }
 
 // --------------------------------------------------
 // --------------------------------------------------
 
-// Custom delay in miliseconds
-//  @param (duration) : the duration of the delay in miliseconds [uint32_t]
-void SMW_SX1262M0::_delay(uint32_t duration){
-  uint32_t stop_time = millis() + duration;
-  while(millis() < stop_time){
-#if defined(ARDUINO_ESP8266_GENERIC) || defined(ARDUINO_ESP8266_NODEMCU) || defined(ARDUINO_ESP8266_THING) || defined(ARDUINO_ESP32_DEV)
-// ESP8266 Generic / NodeMCU / Sparkfun The Thing / ESP32 Dev
-    yield(); // custom function for a non blocking execution with the ESP family
-#else
-    // do nothing
-#endif
-  }
+// Instantiate the templates of the parameters
+//  NOTE: the templates are defined in this file, so every parameter must be listed here.
+
+#define INSTANTIATE_GET(param) \
+  template CommandResponse SMW_SX1262M0::get<param>(ParamDescriptor<param>::type (&));
+
+#define INSTANTIATE_SET(param) \
+  template bool SMW_SX1262M0::begin_set<param>(ParamDescriptor<param>::input, CommandCallback); \
+  template CommandResponse SMW_SX1262M0::set<param>(ParamDescriptor<param>::input);
+
+INSTANTIATE_GET(Param::ADR)
+INSTANTIATE_GET(Param::AJOIN)
+INSTANTIATE_GET(Param::APPEUI)
+INSTANTIATE_GET(Param::APPKEY)
+INSTANTIATE_GET(Param::APPSKEY)
+INSTANTIATE_GET(Param::CFM)
+INSTANTIATE_GET(Param::CFS)
+INSTANTIATE_GET(Param::DADDR)
+INSTANTIATE_GET(Param::DEVEUI)
+INSTANTIATE_GET(Param::DR)
+INSTANTIATE_GET(Param::NJM)
+INSTANTIATE_GET(Param::NJS)
+INSTANTIATE_GET(Param::NWKSKEY)
+INSTANTIATE_GET(Param::RSSI)
+INSTANTIATE_GET(Param::SNR)
+
+INSTANTIATE_SET(Param::ADR)
+INSTANTIATE_SET(Param::AJOIN)
+INSTANTIATE_SET(Param::APPEUI)
+INSTANTIATE_SET(Param::APPKEY)
+INSTANTIATE_SET(Param::APPSKEY)
+INSTANTIATE_SET(Param::CFM)
+INSTANTIATE_SET(Param::DADDR)
+INSTANTIATE_SET(Param::DR)
+INSTANTIATE_SET(Param::NJM)
+INSTANTIATE_SET(Param::NWKSKEY)
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+// Constructor
+//  @param (module) : the module to write to [SMW_SX1262M0]
+SMW_SX1262M0_Writer::SMW_SX1262M0_Writer(SMW_SX1262M0 &module) :
+  _module(&module),
+  _encode(false),
+  _hexadecimal(false),
+  _open(false),
+  _length(0),
+  _refusal(CommandResponse::ERROR)
+  {
 }
 
 // --------------------------------------------------
 
-// Read the response of a command
-//  @param (timeout) : the time to wait for the response in miliseconds [uint32_t]
-//  @returns the type of the response [CommandResponse]
-CommandResponse SMW_SX1262M0::_read_response(uint32_t timeout){
-  _buffer.reset(); // reset for storing the new response
-  
-  // read the incoming data
-  uint8_t c;
-  uint32_t stop_time = millis() + timeout;
-  while(millis() < stop_time){
-    if(_stream->available()){
-      c = _stream->read(); // read the incoming byte
-      
-#ifdef SMW_SX1262M0_DEBUG
-      // debug
-      if(_stream_debug){
-        if(c > 32){
-          _stream_debug->write(c);
-        } else {
-          _stream_debug->print('(');
-          _stream_debug->print(c, HEX);
-          _stream_debug->print(')');
-        }
-      }
-#endif
+// Write a byte of the payload
+//  @param (c) : the byte to write [uint8_t]
+//  @returns the number of bytes written [size_t]
+size_t SMW_SX1262M0_Writer::write(uint8_t c){
+  return write(&c, 1);
+}
 
-      if((c > 31) && (c < 127)){
-        _buffer.append(c);
-      } else if((c == CHAR_CR) || (c == CHAR_LF)){
-        _buffer.append(c);
-      }
+// --------------------------------------------------
+
+// Write bytes of the payload
+//  @param (data) : the bytes to write [uint8_t *]
+//         (size) : the number of bytes [size_t]
+//  @returns the number of bytes written [size_t]
+//  NOTE: the bytes are encoded in small chunks on the stack.
+size_t SMW_SX1262M0_Writer::write(const uint8_t *data, size_t size){
+  if(!_open){
+    return 0;
+  }
+
+  size_t written = size;
+  _length += size;
+  char chunk[SMW_SX1262M0_FRAME_SIZE];
+  while(size > 0){
+    size_t count;
+    if(_encode){
+      count = (size < (sizeof(chunk) / 2)) ? size : (sizeof(chunk) / 2);
+      hex_encode(chunk, data, count);
+      _module->_frame_write(chunk, count * 2);
     } else {
-#if defined(ARDUINO_ESP8266_GENERIC) || defined(ARDUINO_ESP8266_NODEMCU) || defined(ARDUINO_ESP8266_THING) || defined(ARDUINO_ESP32_DEV)
-// ESP8266 Generic / NodeMCU / Sparkfun The Thing / ESP32 Dev
-      yield(); // custom function for a non blocking execution with the ESP family
-#else
-      // do nothing
-#endif
+      count = (size < sizeof(chunk)) ? size : sizeof(chunk);
+      _module->_frame_write(reinterpret_cast<const char *>(data), count);
     }
+    data += count;
+    size -= count;
   }
 
-  // get the status of the message
-  Buffer buffer_status(25);
-  uint8_t buffer_length = _buffer.available();
-  if(buffer_length > 4){ // (the status is returned as "<CR><LF>Status<CR><LF>")
-    uint8_t status = 0;
-    
-    for(int16_t i=(buffer_length - 1) ; i >= 0 ; i--){
-      c = _buffer[i]; // get the current byte
-      
-      if((c == CHAR_CR) || (c == CHAR_LF)){
-        status++; // update
+  return written;
+}
+
+// --------------------------------------------------
+// --------------------------------------------------
 
-        // check for the end of the status message
-        if(status == 4){
-          // get the status and shift the main buffer
-          for(uint8_t j=i ; j < buffer_length ; j++){
-            c = _buffer[i]; // get the current byte
+// Constructor
+//  @param (module) : the module to send the uplinks [SMW_SX1262M0]
+//         (port) : the application port [uint8_t]
+//         (max_age) : the maximum time a record waits to be sent [ms] (default: 0 to disable)
+//         (record_size) : the size of the records [bytes] (default: 0 for records of variable size)
+SMW_SX1262M0_Aggregator::SMW_SX1262M0_Aggregator(SMW_SX1262M0 &module, uint8_t port, uint32_t max_age, uint8_t record_size) :
+  _module(&module),
+  _port(port),
+  _max_age(max_age),
+  _record_size(record_size),
+  _length(0),
+  _count(0),
+  _first_time(0),
+  _urgent(false)
+  {
+}
 
-            // store the byte if valid
-            if((c > 31) && (c < 127)){
-              buffer_status.append(c);
-            }
+// --------------------------------------------------
 
-            _buffer.remove(i); // remove the byte
-          }
-          
-          break; // exit the loop
-        }
-      }
-    }
+// Add a record
+//  @param (data) : the bytes of the record [uint8_t *]
+//         (length) : the number of bytes [uint8_t]
+//         (urgent) : true to send the record immediately [bool] (default: false)
+//  @returns OK if the record was stored, or the reason it was not [CommandResponse]
+//  NOTE: the pending records are sent first if the record doesn't fit the
+//        current uplink. The uplink is also sent when it is full, when the
+//        oldest record expires or for an urgent record; if the module is
+//        busy, the records are kept for <update()>.
+CommandResponse SMW_SX1262M0_Aggregator::add(const uint8_t *data, uint8_t length, bool urgent){
+  if((_record_size > 0) && (length != _record_size)){
+    return CommandResponse::PARAM_ERROR;
   }
 
-  // check for a valid buffer
-  if(!buffer_status.available()){
-    return CommandResponse::ERROR; // wrong result
+  uint8_t capacity = _capacity();
+  uint16_t size = length + ((_record_size > 0) ? 0 : 1); // (doesn't overflow with the prefix of the length)
+  if(size > capacity){
+    return CommandResponse::PARAM_OVERFLOW;
   }
 
-  // trim the main buffer (if necessary)
-  buffer_length = _buffer.available();
-  if(buffer_length){
-    for(int16_t i=(buffer_length - 1) ; i >= 0 ; i--){
-      c = _buffer[i]; // get the current byte
-      
-      if((c == CHAR_CR) || (c == CHAR_LF)){
-        _buffer.remove(i);
-      } else {
-        break; // exit the loop (remove only the trailing characters)
-      }
+  // send the pending records if necessary
+  if((_length + size) > capacity){
+    CommandResponse res = flush();
+    if((res != CommandResponse::OK) || ((_length + size) > capacity)){
+      return (res != CommandResponse::OK) ? res : CommandResponse::BUSY;
     }
   }
 
-  // get a copy of the buffer
-  uint8_t data_length = buffer_status.available();
-  uint8_t data[data_length];
-  buffer_status.copy(data);
-  
-#ifdef SMW_SX1262M0_DEBUG
-  // debug
-  if(_stream_debug){
-    buffer_status.print(_stream_debug);
+  // store the record
+  if(_length == 0){
+    _first_time = millis();
   }
-#endif
-
-  // check for OK
-  if(memcmp(data, RSPNS_OK, strlen(RSPNS_OK)) == 0){
-    return CommandResponse::OK;
+  if(_record_size == 0){
+    _data[_length++] = length;
   }
+  memcpy(&_data[_length], data, length);
+  _length += length;
+  _count++;
 
-  // check for ERROR
-  void *ptr = memmem(data, data_length, RSPNS_ERROR, strlen(RSPNS_ERROR));
-  if(ptr){
-    if(data_length > strlen(RSPNS_ERROR)){
-      return CommandResponse::ERROR;
-    }
+  // send if necessary
+  if(urgent){
+    _urgent = true; // kept until sent
   }
-
-  // check for ERROR - Parameter
-  ptr = memmem(data, data_length, RSPNS_ERROR_PARAMETER, strlen(RSPNS_ERROR_PARAMETER));
-  if(ptr){
-    if(data_length > strlen(RSPNS_ERROR_PARAMETER)){
-      return CommandResponse::ERROR;
-    }
+  if(_urgent || _full(capacity)){
+    flush();
+  } else {
+    update(); // check the age
   }
+  return CommandResponse::OK;
+}
 
-  // check for ERROR - Parameter overflow
-  ptr = memmem(data, data_length, RSPNS_ERROR_PARAMETER_OVERFLOW, strlen(RSPNS_ERROR_PARAMETER_OVERFLOW));
-  if(ptr){
-    if(data_length > strlen(RSPNS_ERROR_PARAMETER_OVERFLOW)){
-      return CommandResponse::ERROR;
-    }
+// --------------------------------------------------
+
+// Discard the pending records
+void SMW_SX1262M0_Aggregator::clear(void){
+  _length = 0;
+  _count = 0;
+  _urgent = false;
+}
+
+// --------------------------------------------------
+
+// Send the pending records
+//  @returns the type of the response [CommandResponse]
+//  NOTE: if the maximum payload decreased (lower data rate), only the first
+//        records are sent.
+CommandResponse SMW_SX1262M0_Aggregator::flush(void){
+  if(_length == 0){
+    return CommandResponse::OK;
   }
 
-  // check for ERROR - Network busy
-  ptr = memmem(data, data_length, RSPNS_ERROR_BUSY, strlen(RSPNS_ERROR_BUSY));
-  if(ptr){
-    if(data_length > strlen(RSPNS_ERROR_BUSY)){
-      return CommandResponse::BUSY;
+  // get the records that fit the uplink
+  uint8_t capacity = _capacity();
+  uint8_t length = 0;
+  uint8_t count = 0;
+  while(length < _length){
+    uint8_t size = (_record_size > 0) ? _record_size : (_data[length] + 1);
+    if((length + size) > capacity){
+      break;
     }
+    length += size;
+    count++;
+  }
+  if(length == 0){
+    return CommandResponse::PARAM_OVERFLOW; // the first record doesn't fit (see <clear()>)
   }
 
-  // check for NO NETWORK
-  ptr = memmem(data, data_length, RSPNS_NO_NETWORK, strlen(RSPNS_NO_NETWORK));
-  if(ptr){
-    if(data_length > strlen(RSPNS_NO_NETWORK)){
-      return CommandResponse::NO_NETWORK;
-    }
+  // send
+  CommandResponse res = _module->sendX(_port, _data, length);
+  if((res == CommandResponse::OK) || _module->_spooled){ // sent or stored in the spool
+    _length -= length;
+    _count -= count;
+    memmove(_data, &_data[length], _length); // keep the remaining records (with their age)
+    _urgent = _urgent && (_length > 0);
   }
+  return res;
+}
+
+// --------------------------------------------------
 
-  return CommandResponse::ERROR; // wrong result
+// Get the number of pending records
+//  @returns the number of records [uint8_t]
+uint8_t SMW_SX1262M0_Aggregator::pending(void){
+  return _count;
 }
 
 // --------------------------------------------------
 
-// Send a command to the module
-//  @param (command) : the command to send [char *]
-//         (action)  : the type of action for the command [CommandAction]
-//         (qty)     : the quantity of other parameters to send [uint8_t]
-//         (...)     : optional and variable data to send [char *]
-void SMW_SX1262M0::_send_command(const char *command, CommandAction action, uint8_t qty, ...){
-  flush(); // flush the data before sendig the command
-  // (it could be done in <readResponse()>, but it might flush some data in some cases - not verified)
-  
-#ifdef SMW_SX1262M0_DEBUG
-  if(_stream_debug){
-    _stream_debug->write('[');
-    _stream_debug->write(CMD_AT);
+// Send the pending records if necessary
+//  @returns the type of the response, or OK if nothing was sent [CommandResponse]
+//  NOTE: call periodically to send the expired records and to retry the full
+//        uplinks that were not accepted.
+CommandResponse SMW_SX1262M0_Aggregator::update(void){
+  if(_length == 0){
+    return CommandResponse::OK;
   }
-#endif
-  _stream->write(CMD_AT); // send the <AT> prefix
-  
-  // check if there is another command
-  if(command){
-    char cmd_action[] = {0,0,0}; // EOS included
-    switch(action){
-      case CommandAction::RUN: {
-        // nothing to do
-        break;
-      }
 
-      case CommandAction::GET: {
-        cmd_action[0] = CHAR_EQUAL;
-        cmd_action[1] = CHAR_QUESTION;
-        break;
-      }
+  bool expired = (_max_age > 0) && ((millis() - _first_time) >= _max_age);
+  if(_urgent || expired || _full(_capacity())){
+    return flush();
+  }
+  return CommandResponse::OK;
+}
 
-      case CommandAction::SET: {
-        cmd_action[0] = CHAR_EQUAL;
-        break;
-      }
+// --------------------------------------------------
+// --------------------------------------------------
 
-      case CommandAction::HELP:
-      default: {
-        cmd_action[0] = CHAR_QUESTION;
-        break;
-      }
-    }
-#ifdef SMW_SX1262M0_DEBUG
-    if(_stream_debug){
-      _stream_debug->write(CHAR_PLUS);
-      _stream_debug->write(command);
-      _stream_debug->write(cmd_action);
-    }
-#endif
-    _stream->write(CHAR_PLUS);
-    _stream->write(command);
-    _stream->write(cmd_action);
-
-    // check if there are paramenters to send
-    if(qty){
-      // get the list of parameters
-      va_list arg_list;
-      va_start(arg_list, qty);
-
-      // write the parameters
-      for(uint8_t i=0 ; i < qty ; i++){
-        char *data = va_arg(arg_list, char *);
-      
-#ifdef SMW_SX1262M0_DEBUG
-        if(_stream_debug){
-          _stream_debug->write(data);
-        }
-#endif
-        _stream->write(data);
+// Get the size of the uplink
+//  @returns the maximum number of bytes [uint8_t]
+uint8_t SMW_SX1262M0_Aggregator::_capacity(void){
+  uint8_t capacity = _module->get_max_payload();
+  return (capacity < SMW_SX1262M0_AGGREGATOR_SIZE) ? capacity : SMW_SX1262M0_AGGREGATOR_SIZE;
+}
 
-        // add the separator if necessary
-        if(i < (qty - 1)){
-#ifdef SMW_SX1262M0_DEBUG
-          if(_stream_debug){
-            _stream_debug->write(CHAR_COLON);
-          }
-#endif
-          _stream->write(CHAR_COLON);
-        }
-      }
+// --------------------------------------------------
 
-      // end using variable argument list
-      va_end(arg_list);
-    }
-  }
-  
-#ifdef SMW_SX1262M0_DEBUG
-  if(_stream_debug){
-    _stream_debug->write(CHAR_CR);
-    _stream_debug->write(']');
-  }
-#endif
-  _stream->write(CHAR_CR);
+// Check if the uplink is full
+//  @param (capacity) : the size of the uplink [bytes]
+//  @returns true if no other record fits [bool]
+bool SMW_SX1262M0_Aggregator::_full(uint8_t capacity){
+  uint8_t minimum = (_record_size > 0) ? _record_size : 2; // (length and 1 byte)
+  return (_length + minimum) > capacity;
 }
 
 // --------------------------------------------------
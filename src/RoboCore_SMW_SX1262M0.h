@@ -27,12 +27,69 @@
 *******************************************************************************/
 
 #define SMW_SX1262M0_DEBUG
+// #define SMW_SX1262M0_CACHE // shadow cache of the parameters (opt-in)
+#if !defined(__AVR__)
+#define SMW_SX1262M0_ADAPTIVE_TIMEOUT // timeouts learned from the latencies (opt-in on AVR, limited by the RAM)
+#define SMW_SX1262M0_CONFIRM // tracked confirmed messages (opt-in on AVR, limited by the RAM)
+#endif
 
-#define SMW_SX1262M0_BUFFER_SIZE            70
+#ifndef SMW_SX1262M0_BUFFER_SIZE
+#if defined(__AVR__)
+#define SMW_SX1262M0_BUFFER_SIZE            70 // [bytes] (limited by the RAM)
+#else
+#define SMW_SX1262M0_BUFFER_SIZE           500 // [bytes] (hexadecimal payload of 242 bytes)
+#endif
+#endif
+#ifndef SMW_SX1262M0_AGGREGATOR_SIZE
+#if defined(__AVR__)
+#define SMW_SX1262M0_AGGREGATOR_SIZE        51 // [bytes] (limited by the RAM)
+#else
+#define SMW_SX1262M0_AGGREGATOR_SIZE       242 // [bytes] (maximum payload of AU915)
+#endif
+#endif
+#define SMW_SX1262M0_AIRTIME_BUDGET          0 // [ms] (time on air per window, 0 to disable)
+#define SMW_SX1262M0_AIRTIME_WINDOW   86400000 // [ms] (24 h)
+#define SMW_SX1262M0_CONFIRM_ATTEMPTS        4 // (transmissions of a confirmed uplink)
+#define SMW_SX1262M0_CONFIRM_BACKOFF      5000 // [ms] (doubled after each attempt)
+#ifndef SMW_SX1262M0_CONFIRM_SIZE
+#if defined(__AVR__)
+#define SMW_SX1262M0_CONFIRM_SIZE           51 // [bytes] (limited by the RAM)
+#else
+#define SMW_SX1262M0_CONFIRM_SIZE          242 // [bytes] (maximum payload of AU915)
+#endif
+#endif
 #define SMW_SX1262M0_DELAY_INCOMING_DATA    10 // [ms]
-#define SMW_SX1262M0_TIMEOUT_READ          100 // [ms]
-#define SMW_SX1262M0_TIMEOUT_RESET        3000 // [ms]
-#define SMW_SX1262M0_TIMEOUT_WRITE         500 // [ms]
+#define SMW_SX1262M0_DOWNLINK_HANDLERS       4
+#define SMW_SX1262M0_DUTY_CYCLE              0 // [%] (0 to disable)
+#define SMW_SX1262M0_DWELL_TIME              0 // [ms] (0 to disable, 400 for the dwell time limit of AU915)
+#define SMW_SX1262M0_FRAME_SIZE             48 // [bytes] (stack buffer to build a command)
+#define SMW_SX1262M0_LATENCY_BINS           22 // (half octaves from 4 ms, the last one for the overflow)
+#define SMW_SX1262M0_LATENCY_SAMPLES         8 // (minimum to replace the default timeout)
+#define SMW_SX1262M0_PROBE_ATTEMPTS          4 // (pings after the reset)
+#define SMW_SX1262M0_PROBE_DELAY            10 // [ms] (doubled after each attempt)
+#ifndef SMW_SX1262M0_QUEUE_BUFFER_SIZE
+#if defined(__AVR__)
+#define SMW_SX1262M0_QUEUE_BUFFER_SIZE      64 // [bytes] (limited by the RAM, the longest frame with a key)
+#else
+#define SMW_SX1262M0_QUEUE_BUFFER_SIZE     128 // [bytes]
+#endif
+#endif
+#define SMW_SX1262M0_QUEUE_IN_FLIGHT         2 // [commands] (sent before the first response)
+#ifndef SMW_SX1262M0_QUEUE_SIZE
+#if defined(__AVR__)
+#define SMW_SX1262M0_QUEUE_SIZE              2 // [commands] (limited by the RAM)
+#else
+#define SMW_SX1262M0_QUEUE_SIZE              4 // [commands]
+#endif
+#endif
+#define SMW_SX1262M0_RX_WINDOWS           2100 // [ms] (busy after an uplink, until the end of RX2)
+#define SMW_SX1262M0_SPOOL_RETRY         30000 // [ms] (after an uplink without network)
+#define SMW_SX1262M0_TIMEOUT_MARGIN         20 // [ms]
+#define SMW_SX1262M0_TIMEOUT_PERCENTILE     99 // [%]
+#define SMW_SX1262M0_TIMEOUT_READ          100 // [ms] (default)
+#define SMW_SX1262M0_TIMEOUT_RESET        3000 // [ms] (default)
+#define SMW_SX1262M0_TIMEOUT_WRITE         500 // [ms] (default)
+#define SMW_SX1262M0_URC_BUFFER_SIZE        40
 
 
 // --------------------------------------------------
@@ -46,7 +103,12 @@ extern "C" {
   #include <stdlib.h>
 }
 
+#include "Airtime.h"
 #include "Buffer.h"
+#include "HexCodec.h"
+#include "PatternMatcher.h"
+#include "PayloadSchema.h"
+#include "Spool.h"
 
 
 // --------------------------------------------------
@@ -67,48 +129,52 @@ const char CHAR_QUESTION = 63; // '?'
 // --------------------------------------------------
 // Constants (AT v2.14)
 
-const char* const CMD_AT = "AT";
+constexpr const char* CMD_AT = "AT";
 
 char* const CMD_NONE = nullptr;
 
-const char* const CMD_RESET = "ATZ"; // Reset (3.1.3)
-
-const char* const CMD_APPEUI = "APPEUI"; // Application EUI (3.2.1)
-const char* const CMD_APPKEY = "APPKEY"; // Application Key (3.2.1)
-const char* const CMD_APPSKEY = "APPSKEY"; // Application Session Key (3.2.3)
-const char* const CMD_DADDR = "DADDR"; // Device Address (3.2.4)
-const char* const CMD_DEVEUI = "DEUI"; // Device EUI (3.2.5)
-const char* const CMD_NWKID = "NWKID"; // Network ID (3.2.6)
-const char* const CMD_NWKSKEY = "NWKSKEY"; // Network Session Key (3.2.7)
-const char* const CMD_CFM = "CFM"; // Confirm Mode (3.3.1)
-const char* const CMD_CFS = "CFS"; // Confirm Status (3.3.2)
-const char* const CMD_JOIN = "JOIN"; // Join (3.3.3)
-const char* const CMD_NJM = "NJM"; // Join Mode (3.3.4)
-const char* const CMD_NJS = "NJS"; // Join Status (3.3.5)
-const char* const CMD_RECV = "RECV"; // Receive (3.3.6)
-const char* const CMD_RECVB = "RECVB"; // Receive - Binary (3.3.7)
-const char* const CMD_SEND = "SEND"; // Send (3.3.8)
-const char* const CMD_SENDB = "SENDB"; // Send - Binary (3.3.9)
-const char* const CMD_ADR = "ADR"; // Adaptive Data Rate (3.4.1)
-const char* const CMD_CLASS = "CLASS"; // LoRaWAN Class (3.4.2)
-const char* const CMD_DR = "DR"; // Data Rate (3.4.4)
-const char* const CMD_TXP = "TXP"; // Transmit Power (3.4.12)
-const char* const CMD_RSSI = "RSSI"; // RSSI (3.7.1)
-const char* const CMD_SNR = "SNR"; // SNR (3.7.2)
-const char* const CMD_VERSION = "VER"; // Version (3.7.4)
-const char* const CMD_LORA_TX = "TXLRA"; // TX LoRa Test (3.8.1)
-const char* const CMD_LORA_RX = "RXLRA"; // RX LoRa Test (3.8.4)
-const char* const CMD_LORA_CONFIG = "TCONF"; // Configuration of LoRa Test (3.8.5)
-const char* const CMD_LORA_OFF = "TOFF"; // Stop LoRa Test (3.8.6)
-const char* const CMD_SAVE = "SAVE"; // Save configuration (3.10.1)
-const char* const CMD_AJOIN = "AJOIN"; // Automatic Join (3.10.3)
-
-const char* const RSPNS_OK = "OK";
-const char* const RSPNS_ERROR = "AT_ERROR";
-const char* const RSPNS_ERROR_BUSY = "AT_BUSY_ERROR";
-const char* const RSPNS_ERROR_PARAMETER = "AT_PARAM_ERROR";
-const char* const RSPNS_ERROR_PARAMETER_OVERFLOW = "AT_TEST_PARAM_OVERFLOW";
-const char* const RSPNS_NO_NETWORK = "AT_NO_NETWORK_JOINED";
+constexpr const char* CMD_RESET = "ATZ"; // Reset (3.1.3)
+
+constexpr const char* CMD_APPEUI = "APPEUI"; // Application EUI (3.2.1)
+constexpr const char* CMD_APPKEY = "APPKEY"; // Application Key (3.2.1)
+constexpr const char* CMD_APPSKEY = "APPSKEY"; // Application Session Key (3.2.3)
+constexpr const char* CMD_DADDR = "DADDR"; // Device Address (3.2.4)
+constexpr const char* CMD_DEVEUI = "DEUI"; // Device EUI (3.2.5)
+constexpr const char* CMD_NWKID = "NWKID"; // Network ID (3.2.6)
+constexpr const char* CMD_NWKSKEY = "NWKSKEY"; // Network Session Key (3.2.7)
+constexpr const char* CMD_CFM = "CFM"; // Confirm Mode (3.3.1)
+constexpr const char* CMD_CFS = "CFS"; // Confirm Status (3.3.2)
+constexpr const char* CMD_JOIN = "JOIN"; // Join (3.3.3)
+constexpr const char* CMD_NJM = "NJM"; // Join Mode (3.3.4)
+constexpr const char* CMD_NJS = "NJS"; // Join Status (3.3.5)
+constexpr const char* CMD_RECV = "RECV"; // Receive (3.3.6)
+constexpr const char* CMD_RECVB = "RECVB"; // Receive - Binary (3.3.7)
+constexpr const char* CMD_SEND = "SEND"; // Send (3.3.8)
+constexpr const char* CMD_SENDB = "SENDB"; // Send - Binary (3.3.9)
+constexpr const char* CMD_ADR = "ADR"; // Adaptive Data Rate (3.4.1)
+constexpr const char* CMD_CLASS = "CLASS"; // LoRaWAN Class (3.4.2)
+constexpr const char* CMD_DR = "DR"; // Data Rate (3.4.4)
+constexpr const char* CMD_TXP = "TXP"; // Transmit Power (3.4.12)
+constexpr const char* CMD_RSSI = "RSSI"; // RSSI (3.7.1)
+constexpr const char* CMD_SNR = "SNR"; // SNR (3.7.2)
+constexpr const char* CMD_VERSION = "VER"; // Version (3.7.4)
+constexpr const char* CMD_LORA_TX = "TXLRA"; // TX LoRa Test (3.8.1)
+constexpr const char* CMD_LORA_RX = "RXLRA"; // RX LoRa Test (3.8.4)
+constexpr const char* CMD_LORA_CONFIG = "TCONF"; // Configuration of LoRa Test (3.8.5)
+constexpr const char* CMD_LORA_OFF = "TOFF"; // Stop LoRa Test (3.8.6)
+constexpr const char* CMD_SAVE = "SAVE"; // Save configuration (3.10.1)
+constexpr const char* CMD_AJOIN = "AJOIN"; // Automatic Join (3.10.3)
+
+constexpr const char* RSPNS_OK = "OK";
+constexpr const char* RSPNS_ERROR = "AT_ERROR";
+constexpr const char* RSPNS_ERROR_BUSY = "AT_BUSY_ERROR";
+constexpr const char* RSPNS_ERROR_PARAMETER = "AT_PARAM_ERROR";
+constexpr const char* RSPNS_ERROR_PARAMETER_OVERFLOW = "AT_TEST_PARAM_OVERFLOW";
+constexpr const char* RSPNS_NO_NETWORK = "AT_NO_NETWORK_JOINED";
+
+constexpr const char* URC_BOOT = "ATtention"; // Boot message
+constexpr const char* URC_JOINED = "JOINED"; // Join accepted
+constexpr const char* URC_RECEIVED = "+RX"; // Downlink received (depends on the firmware)
 
 
 // --------------------------------------------------
@@ -120,6 +186,9 @@ const char* const RSPNS_NO_NETWORK = "AT_NO_NETWORK_JOINED";
 #define SMW_SX1262M0_AUTOMATIC_JOIN_OFF  0
 #define SMW_SX1262M0_AUTOMATIC_JOIN_ON   1
 
+#define SMW_SX1262M0_CONFIRMED_OFF  0
+#define SMW_SX1262M0_CONFIRMED_ON   1
+
 #define SMW_SX1262M0_JOIN_MODE_ABP  0
 #define SMW_SX1262M0_JOIN_MODE_OTAA 1
 
@@ -127,7 +196,20 @@ const char* const RSPNS_NO_NETWORK = "AT_NO_NETWORK_JOINED";
 #define SMW_SX1262M0_JOIN_STATUS_JOINED     1
 
 enum class CommandAction : uint8_t { RUN , GET , SET , HELP };
-enum class CommandResponse : uint8_t { OK , ERROR , BUSY , NO_NETWORK , DATA };
+enum class CommandResponse : uint8_t { OK , ERROR , BUSY , NO_NETWORK , DATA , PARAM_ERROR , PARAM_OVERFLOW };
+
+enum class URCType : uint8_t { BOOT , JOINED , RECEIVED , OTHER };
+#define SMW_SX1262M0_URC_TYPES 4
+
+enum class TimeoutClass : uint8_t { READ , WRITE , SAVE , SEND , RESET , MODE , NONE };
+#define SMW_SX1262M0_TIMEOUT_CLASSES 6
+
+enum class ConfirmStatus : uint8_t { NONE , PENDING , ACKNOWLEDGED , FAILED };
+
+typedef void (*CommandCallback)(CommandResponse, Buffer (&));
+typedef void (*ConfirmCallback)(uint8_t, ConfirmStatus);
+typedef void (*URCCallback)(URCType, Buffer (&));
+typedef void (*DownlinkCallback)(uint8_t, const uint8_t *, buffer_size_t);
 
 
 // --------------------------------------------------
@@ -140,6 +222,250 @@ enum class CommandResponse : uint8_t { OK , ERROR , BUSY , NO_NETWORK , DATA };
 #define SMW_SX1262M0_SIZE_DEVADDR    8
 #define SMW_SX1262M0_SIZE_NWKSKEY   32
 #define SMW_SX1262M0_SIZE_VERSION    3
+#define SMW_SX1262M0_SIZE_SIGNAL     5
+
+
+// --------------------------------------------------
+// Parameters
+
+enum class Param : uint8_t { ADR , AJOIN , APPEUI , APPKEY , APPSKEY , CFM , CFS , DADDR , DEVEUI , DR , NJM , NJS , NWKSKEY , RSSI , SNR };
+
+// The policy to parse and format the value of a parameter
+//  BOOLEAN     : a single digit, forced to 0 or 1 when set
+//  DIGIT       : a single digit, up to a maximum value when set
+//  HEXADECIMAL : hexadecimal digits, separated by ':' when set
+//  DECIMAL     : a signed decimal number (read only)
+enum class ParamPolicy : uint8_t { BOOLEAN , DIGIT , HEXADECIMAL , DECIMAL };
+
+// The input of a parameter that can't be set
+//  NOTE: the type is incomplete on purpose, so <set<P>()> doesn't compile for this parameter.
+struct ParamReadOnly;
+
+// The type of the value to set a parameter
+template <ParamPolicy POLICY, bool WRITABLE>
+struct ParamInput {
+  typedef uint8_t type;
+};
+
+template <>
+struct ParamInput<ParamPolicy::HEXADECIMAL, true> {
+  typedef const char* type;
+};
+
+template <ParamPolicy POLICY>
+struct ParamInput<POLICY, false> {
+  typedef ParamReadOnly type;
+};
+
+// The common traits of a parameter
+//  @param (T) : the type of the value [typename]
+//         (POLICY) : the policy to parse and format the value [ParamPolicy]
+//         (WIDTH) : the number of characters of the value [uint8_t]
+//         (MAXIMUM) : the maximum value to set (DIGIT only) [uint8_t] (default: 0)
+//         (WRITABLE) : false if the parameter is read only [bool] (default: true)
+//         (RESET) : true if the module is reset when the parameter is set [bool] (default: false)
+//         (TIMEOUT) : the class of the timeout of the SET command [TimeoutClass] (default: WRITE)
+//  NOTE: the volatile parameters redefine <cached> to false.
+template <typename T, ParamPolicy POLICY, uint8_t WIDTH, uint8_t MAXIMUM = 0, bool WRITABLE = true, bool RESET = false, TimeoutClass TIMEOUT = TimeoutClass::WRITE>
+struct ParamTraits {
+  typedef T type;
+  typedef typename ParamInput<POLICY, WRITABLE>::type input;
+  static constexpr ParamPolicy policy = POLICY;
+  static constexpr uint8_t width = WIDTH;
+  static constexpr uint8_t maximum = MAXIMUM;
+  static constexpr bool reset = RESET;
+  static constexpr bool cached = true;
+  static constexpr TimeoutClass timeout_get = TimeoutClass::READ;
+  static constexpr TimeoutClass timeout_set = TIMEOUT;
+};
+
+// The descriptor of a parameter (<command> is the AT command of the parameter)
+template <Param P>
+struct ParamDescriptor;
+
+template <>
+struct ParamDescriptor<Param::ADR> : ParamTraits<uint8_t, ParamPolicy::BOOLEAN, 1> {
+  static constexpr const char* command = CMD_ADR;
+};
+
+template <>
+struct ParamDescriptor<Param::AJOIN> : ParamTraits<uint8_t, ParamPolicy::BOOLEAN, 1> {
+  static constexpr const char* command = CMD_AJOIN;
+};
+
+template <>
+struct ParamDescriptor<Param::APPEUI> : ParamTraits<char[SMW_SX1262M0_SIZE_APPEUI], ParamPolicy::HEXADECIMAL, SMW_SX1262M0_SIZE_APPEUI> {
+  static constexpr const char* command = CMD_APPEUI;
+};
+
+template <>
+struct ParamDescriptor<Param::APPKEY> : ParamTraits<char[SMW_SX1262M0_SIZE_APPKEY], ParamPolicy::HEXADECIMAL, SMW_SX1262M0_SIZE_APPKEY> {
+  static constexpr const char* command = CMD_APPKEY;
+};
+
+template <>
+struct ParamDescriptor<Param::APPSKEY> : ParamTraits<char[SMW_SX1262M0_SIZE_APPSKEY], ParamPolicy::HEXADECIMAL, SMW_SX1262M0_SIZE_APPSKEY> {
+  static constexpr const char* command = CMD_APPSKEY;
+};
+
+template <>
+struct ParamDescriptor<Param::CFM> : ParamTraits<uint8_t, ParamPolicy::BOOLEAN, 1> {
+  static constexpr const char* command = CMD_CFM;
+};
+
+template <>
+struct ParamDescriptor<Param::CFS> : ParamTraits<uint8_t, ParamPolicy::DIGIT, 1, 0, false> {
+  static constexpr const char* command = CMD_CFS;
+  static constexpr bool cached = false;
+};
+
+template <>
+struct ParamDescriptor<Param::DADDR> : ParamTraits<char[SMW_SX1262M0_SIZE_DEVADDR], ParamPolicy::HEXADECIMAL, SMW_SX1262M0_SIZE_DEVADDR> {
+  static constexpr const char* command = CMD_DADDR;
+};
+
+template <>
+struct ParamDescriptor<Param::DEVEUI> : ParamTraits<char[SMW_SX1262M0_SIZE_DEVEUI], ParamPolicy::HEXADECIMAL, SMW_SX1262M0_SIZE_DEVEUI, 0, false> {
+  static constexpr const char* command = CMD_DEVEUI;
+};
+
+template <>
+struct ParamDescriptor<Param::DR> : ParamTraits<uint8_t, ParamPolicy::DIGIT, 1, 6> {
+  static constexpr const char* command = CMD_DR;
+};
+
+template <>
+struct ParamDescriptor<Param::NJM> : ParamTraits<uint8_t, ParamPolicy::DIGIT, 1, SMW_SX1262M0_JOIN_MODE_OTAA, true, true, TimeoutClass::MODE> {
+  static constexpr const char* command = CMD_NJM;
+};
+
+template <>
+struct ParamDescriptor<Param::NJS> : ParamTraits<uint8_t, ParamPolicy::DIGIT, 1, 0, false> {
+  static constexpr const char* command = CMD_NJS;
+  static constexpr bool cached = false;
+};
+
+template <>
+struct ParamDescriptor<Param::NWKSKEY> : ParamTraits<char[SMW_SX1262M0_SIZE_NWKSKEY], ParamPolicy::HEXADECIMAL, SMW_SX1262M0_SIZE_NWKSKEY> {
+  static constexpr const char* command = CMD_NWKSKEY;
+};
+
+template <>
+struct ParamDescriptor<Param::RSSI> : ParamTraits<float, ParamPolicy::DECIMAL, SMW_SX1262M0_SIZE_SIGNAL, 0, false> {
+  static constexpr const char* command = CMD_RSSI;
+  static constexpr bool cached = false;
+};
+
+template <>
+struct ParamDescriptor<Param::SNR> : ParamTraits<float, ParamPolicy::DECIMAL, SMW_SX1262M0_SIZE_SIGNAL, 0, false> {
+  static constexpr const char* command = CMD_SNR;
+  static constexpr bool cached = false;
+};
+
+#ifdef SMW_SX1262M0_CACHE
+
+// The cached value of a parameter
+template <Param P>
+struct ParamCacheEntry {
+  typename ParamDescriptor<P>::type value;
+};
+
+// The shadow cache of the parameters (one entry for each cached parameter)
+struct ParamCache :
+  ParamCacheEntry<Param::ADR>,
+  ParamCacheEntry<Param::AJOIN>,
+  ParamCacheEntry<Param::APPEUI>,
+  ParamCacheEntry<Param::APPKEY>,
+  ParamCacheEntry<Param::APPSKEY>,
+  ParamCacheEntry<Param::CFM>,
+  ParamCacheEntry<Param::DADDR>,
+  ParamCacheEntry<Param::DEVEUI>,
+  ParamCacheEntry<Param::DR>,
+  ParamCacheEntry<Param::NJM>,
+  ParamCacheEntry<Param::NWKSKEY> {
+  uint16_t valid; // one bit for each parameter
+};
+
+#endif
+
+
+// --------------------------------------------------
+// Configuration
+
+#define SMW_SX1262M0_CONFIG_KEEP  0xFF
+
+// The desired configuration of the module
+//  NOTE: the fields that are not assigned (SMW_SX1262M0_CONFIG_KEEP or nullptr) are not changed.
+struct SMW_SX1262M0_Config {
+  uint8_t join_mode = SMW_SX1262M0_CONFIG_KEEP;
+  uint8_t adr = SMW_SX1262M0_CONFIG_KEEP;
+  uint8_t ajoin = SMW_SX1262M0_CONFIG_KEEP;
+  uint8_t confirmed = SMW_SX1262M0_CONFIG_KEEP;
+  uint8_t dr = SMW_SX1262M0_CONFIG_KEEP;
+  const char *appeui = nullptr;
+  const char *appkey = nullptr;
+  const char *devaddr = nullptr;
+  const char *appskey = nullptr;
+  const char *nwkskey = nullptr;
+};
+
+
+// --------------------------------------------------
+// Streaming send
+
+class SMW_SX1262M0;
+
+// The writer of the payload of a message (see <SMW_SX1262M0::begin_send()>)
+//  NOTE: the data is written to the module as it is printed, so the payload
+//        is never stored in RAM.
+class SMW_SX1262M0_Writer : public Print {
+  public:
+    SMW_SX1262M0_Writer(SMW_SX1262M0 (&));
+    size_t write(uint8_t);
+    size_t write(const uint8_t *, size_t);
+    using Print::write;
+
+  private:
+    SMW_SX1262M0 *_module;
+    bool _encode;
+    bool _hexadecimal;
+    bool _open;
+    size_t _length;
+    CommandResponse _refusal;
+
+    friend class SMW_SX1262M0;
+};
+
+
+// --------------------------------------------------
+// Aggregation
+
+// The queue of records packed in the same uplink
+//  NOTE: the records are never split between two uplinks. The records of
+//        variable size are preceded by their length (1 byte).
+class SMW_SX1262M0_Aggregator {
+  public:
+    SMW_SX1262M0_Aggregator(SMW_SX1262M0 (&), uint8_t, uint32_t = 0, uint8_t = 0);
+    CommandResponse add(const uint8_t *, uint8_t, bool = false);
+    void clear(void);
+    CommandResponse flush(void);
+    uint8_t pending(void);
+    CommandResponse update(void);
+
+  private:
+    SMW_SX1262M0 *_module;
+    uint8_t _port;
+    uint32_t _max_age;
+    uint8_t _record_size;
+    uint8_t _data[SMW_SX1262M0_AGGREGATOR_SIZE];
+    uint8_t _length;
+    uint8_t _count;
+    uint32_t _first_time;
+    bool _urgent;
+
+    uint8_t _capacity(void);
+    bool _full(uint8_t);
+};
 
 
 // --------------------------------------------------
@@ -148,21 +474,53 @@ enum class CommandResponse : uint8_t { OK , ERROR , BUSY , NO_NETWORK , DATA };
 class SMW_SX1262M0 {
   public:
     SMW_SX1262M0(Stream (&));
+    CommandResponse apply(const SMW_SX1262M0_Config (&));
+    bool begin_join(CommandCallback = nullptr);
+    SMW_SX1262M0_Writer& begin_send(uint8_t, bool = false);
+    bool begin_P2P_listen(uint32_t, CommandCallback = nullptr);
+    bool begin_ping(CommandCallback = nullptr);
+    bool begin_readT(CommandCallback = nullptr);
+    bool begin_readX(CommandCallback = nullptr);
+    bool begin_reset(CommandCallback = nullptr);
+    bool begin_save(CommandCallback = nullptr);
+    bool begin_sendT(uint8_t, const char *, CommandCallback = nullptr);
+    bool begin_sendX(uint8_t, const char *, CommandCallback = nullptr);
+    bool begin_sendX(uint8_t, const uint8_t *, size_t, CommandCallback = nullptr);
+    template <Param P> bool begin_set(typename ParamDescriptor<P>::input, CommandCallback = nullptr);
+    bool begin_set_ADR(uint8_t, CommandCallback = nullptr);
+    bool begin_set_AJoin(uint8_t, CommandCallback = nullptr);
+    bool begin_set_AppEUI(const char *, CommandCallback = nullptr);
+    bool begin_set_AppKey(const char *, CommandCallback = nullptr);
+    bool begin_set_AppSKey(const char *, CommandCallback = nullptr);
+    bool begin_set_Confirmed(uint8_t, CommandCallback = nullptr);
+    bool begin_set_DevAddr(const char *, CommandCallback = nullptr);
+    bool begin_set_DR(uint8_t, CommandCallback = nullptr);
+    bool begin_set_JoinMode(uint8_t, CommandCallback = nullptr);
+    bool begin_set_NwkSKey(const char *, CommandCallback = nullptr);
+    bool busy(void);
+    CommandResponse end_send(void);
     void flush(void);
+    template <Param P> CommandResponse get(typename ParamDescriptor<P>::type (&));
     CommandResponse get_ADR(uint8_t (&));
     CommandResponse get_AJoin(uint8_t (&));
     CommandResponse get_AppEUI(char (&)[SMW_SX1262M0_SIZE_APPEUI]);
     CommandResponse get_AppKey(char (&)[SMW_SX1262M0_SIZE_APPKEY]);
     CommandResponse get_AppSKey(char (&)[SMW_SX1262M0_SIZE_APPSKEY]);
     void get_buffer(Buffer (&));
+    CommandResponse get_Confirmed(uint8_t (&));
     CommandResponse get_DevAddr(char (&)[SMW_SX1262M0_SIZE_DEVADDR]);
     CommandResponse get_DevEUI(char (&)[SMW_SX1262M0_SIZE_DEVEUI]);
     CommandResponse get_DR(uint8_t (&));
     CommandResponse get_JoinMode(uint8_t (&));
     CommandResponse get_JoinStatus(uint8_t (&));
+    uint8_t get_max_payload(void);
     CommandResponse get_NwkSKey(char (&)[SMW_SX1262M0_SIZE_NWKSKEY]);
+    void get_P2P_signal(float (&), float (&));
+    CommandResponse get_response(void);
     CommandResponse get_RSSI(float (&));
+    uint32_t get_send_delay(size_t);
     CommandResponse get_SNR(float (&));
+    uint32_t get_timeout(TimeoutClass);
     CommandResponse get_Version(uint8_t (&)[SMW_SX1262M0_SIZE_VERSION]);
     bool isConnected(void);
     CommandResponse join(void);
@@ -171,43 +529,217 @@ class SMW_SX1262M0 {
     CommandResponse P2P_start(uint32_t = 915200, bool = false, const char * = nullptr);
     CommandResponse P2P_stop(void);
     CommandResponse ping(void);
+    bool poll(void);
     CommandResponse readT(void);
     CommandResponse readT(Buffer (&));
     CommandResponse readT(uint8_t (&), Buffer (&));
     CommandResponse readX(void);
     CommandResponse readX(Buffer (&));
     CommandResponse readX(uint8_t (&), Buffer (&));
-    CommandResponse reset(void);
+    CommandResponse readX(uint8_t (&), uint8_t *, size_t, size_t (&));
+    CommandResponse reset(bool = false);
     CommandResponse save(void);
     CommandResponse sendT(uint8_t, const char *);
     CommandResponse sendT(uint8_t, const String);
     CommandResponse sendX(uint8_t, const char *);
     CommandResponse sendX(uint8_t, const String);
+    CommandResponse sendX(uint8_t, const uint8_t *, size_t);
+    template <Param P> CommandResponse set(typename ParamDescriptor<P>::input);
     CommandResponse set_ADR(uint8_t);
     CommandResponse set_AJoin(uint8_t);
     CommandResponse set_AppEUI(const char *);
     CommandResponse set_AppKey(const char *);
     CommandResponse set_AppSKey(const char *);
+    CommandResponse set_Confirmed(uint8_t);
     CommandResponse set_DevAddr(const char *);
+    bool set_downlink_handler(uint8_t, DownlinkCallback);
     CommandResponse set_DR(uint8_t);
     CommandResponse set_JoinMode(uint8_t);
     CommandResponse set_NwkSKey(const char *);
+    void set_spool(Spool *);
+    void set_URC_handler(URCType, URCCallback);
+    void take_buffer(Buffer (&));
+
+#ifdef SMW_SX1262M0_ADAPTIVE_TIMEOUT
+    void set_timeout_policy(uint8_t, uint16_t);
+#endif
+
+#ifdef SMW_SX1262M0_CONFIRM
+    uint8_t begin_send_confirmed(uint8_t, const uint8_t *, size_t);
+    ConfirmStatus get_confirm_status(uint8_t);
+    void set_confirm_handler(ConfirmCallback);
+#endif
+
+#ifdef SMW_SX1262M0_CACHE
+    void get_cache_stats(uint16_t (&), uint16_t (&));
+    void invalidate_cache(void);
+#endif
 
 #ifdef SMW_SX1262M0_DEBUG
     void set_debugger(Stream *);
 #endif
 
   private:
+    friend class SMW_SX1262M0_Aggregator;
+    friend class SMW_SX1262M0_Writer;
+
+    enum class Phase : uint8_t { NONE , RESPONSE , RECEIVE , BANNER , MARKER , LISTEN };
+    enum class P2PField : uint8_t { NOTHING , RSSI , SNR , DATA };
+    enum class ConfirmState : uint8_t { IDLE , SEND , CHECK , SENDING , WAIT , QUERY };
+    enum class ApplyStep : uint8_t { READ , COMPARE , SET , STORE };
+
+    struct QueueEntry {
+      CommandCallback callback;
+      uint32_t timeout;
+      uint8_t length;
+      Phase phase;
+      TimeoutClass type;
+      bool barrier;
+      bool confirm;
+      bool apply;
+      Param param;
+      bool spool;
+    };
+
+    struct DownlinkHandler {
+      uint8_t port;
+      DownlinkCallback handler;
+    };
+
     Stream* _stream;
-    Buffer _buffer;
+    StaticBuffer<SMW_SX1262M0_BUFFER_SIZE> _buffer;
+    bool _line_open;
+    buffer_size_t _line_start;
+    buffer_size_t _data_length;
+    uint8_t _status_index;
+    uint8_t _status_length;
+    CommandCallback _callback;
+    Phase _phase;
+    CommandResponse _response;
+    uint32_t _start_time;
+    uint32_t _stop_time;
+    TimeoutClass _timeout_class;
+    bool _found;
+    PatternMatcher _matcher;
+    uint8_t _match_index;
+    P2PField _p2p_field;
+    char _p2p_value[5];
+    uint8_t _p2p_value_index;
+    float _p2p_rssi;
+    float _p2p_snr;
+    Buffer *_p2p_target;
+    QueueEntry _queue[SMW_SX1262M0_QUEUE_SIZE];
+    uint8_t _queue_head;
+    uint8_t _queue_count;
+    uint8_t _queue_sent;
+    uint8_t _queue_data[SMW_SX1262M0_QUEUE_BUFFER_SIZE];
+    uint8_t _queue_data_head;
+    uint8_t _queue_data_tail;
+    uint8_t _queue_data_count;
+    bool _frame_direct;
+    uint8_t _frame_length;
+    bool _frame_overflow;
+    StaticBuffer<SMW_SX1262M0_URC_BUFFER_SIZE> _urc_buffer;
+    SMW_SX1262M0_Writer _writer;
+    bool _urc_line_open;
+    URCCallback _urc_handlers[SMW_SX1262M0_URC_TYPES];
+    bool _joined;
+    DownlinkHandler _downlink_handlers[SMW_SX1262M0_DOWNLINK_HANDLERS];
+    bool _rx_parsing;
+    bool _rx_valid;
+    uint8_t _rx_port;
+    buffer_size_t _rx_offset;
+
+    AirtimeScheduler _scheduler;
+    uint8_t _data_rate;
+
+    const SMW_SX1262M0_Config *_apply_config;
+    uint16_t _apply_mask;
+    bool _apply_reading;
+    CommandResponse _apply_response;
+
+    Spool *_spool;
+    uint32_t _spool_time;
+    bool _spool_sending;
+    bool _spooled;
     
+#ifdef SMW_SX1262M0_ADAPTIVE_TIMEOUT
+    uint8_t _latency[SMW_SX1262M0_TIMEOUT_CLASSES][SMW_SX1262M0_LATENCY_BINS];
+    uint8_t _timeout_percentile;
+    uint16_t _timeout_margin;
+#endif
+
+#ifdef SMW_SX1262M0_CONFIRM
+    ConfirmState _confirm_state;
+    ConfirmStatus _confirm_status;
+    uint8_t _confirm_ticket;
+    uint8_t _confirm_attempts;
+    uint32_t _confirm_time;
+    bool _confirm_restore;
+    uint8_t _confirm_mode;
+    uint8_t _confirm_port;
+    uint8_t _confirm_length;
+    uint8_t _confirm_data[SMW_SX1262M0_CONFIRM_SIZE];
+    ConfirmCallback _confirm_handler;
+#endif
+
+#ifdef SMW_SX1262M0_CACHE
+    ParamCache _cache;
+    uint16_t _cache_hits;
+    uint16_t _cache_misses;
+#endif
+
 #ifdef SMW_SX1262M0_DEBUG
     Stream* _stream_debug;
 #endif
 
+    void _apply_complete(Param, CommandResponse);
+    uint16_t _apply_read(uint16_t);
+    bool _apply_step(Param, ApplyStep);
+    template <Param P> bool _apply_step(typename ParamDescriptor<P>::input, ApplyStep);
+    void _apply_write(uint16_t);
+    void _begin(Phase, TimeoutClass, uint32_t, CommandCallback);
+    bool _begin_send(const char *, uint8_t, const char *, CommandCallback);
+    CommandResponse _begin_stream(const char *, uint8_t, bool);
+    void _build_command(const char *, CommandAction, uint8_t, va_list);
+    CommandResponse _check_uplink(size_t);
+    void _complete(CommandResponse);
+    void _copy_downlink(uint8_t (&), Buffer (&));
     void _delay(uint32_t);
-    CommandResponse _read_response(uint32_t);
+    void _dispatch_downlink(void);
+    void _dispatch_URC(URCType);
+    uint8_t _frame_append(char (&)[SMW_SX1262M0_FRAME_SIZE], uint8_t, const char *);
+    uint8_t _frame_append(char (&)[SMW_SX1262M0_FRAME_SIZE], uint8_t, const uint8_t *, size_t);
+    void _frame_begin(bool = true);
+    void _frame_end(void);
+    void _frame_write(const char *, uint8_t);
+    void _match_status(uint8_t);
+    bool _match_URC(Buffer (&), buffer_size_t, URCType (&));
+    bool _parse_banner(uint8_t);
+    bool _parse_marker(uint8_t);
+    bool _parse_P2P(uint8_t);
+    void _parse_URC(uint8_t);
+    void _pump(void);
+    bool _push_uplink(size_t, CommandCallback);
+    void _queue_command(const char *, CommandAction, uint8_t = 0, ...);
+    void _queue_frame(const char *, uint8_t);
+    bool _queue_push(Phase, TimeoutClass, CommandCallback, bool = false, uint32_t = 0);
+    CommandResponse _read_response(TimeoutClass);
+    void _record_latency(bool);
     void _send_command(const char *,CommandAction, uint8_t = 0, ...);
+    void _send_frame(const char *, uint8_t);
+    void _spool_complete(CommandResponse);
+    void _spool_store(uint8_t, const uint8_t *, size_t, CommandResponse);
+    void _spool_store(uint8_t, const char *, size_t, CommandResponse);
+    void _spool_update(void);
+    bool _tokenize(uint8_t, CommandResponse (&));
+    CommandResponse _wait(void);
+
+#ifdef SMW_SX1262M0_CONFIRM
+    void _confirm_complete(CommandResponse);
+    void _confirm_resolve(ConfirmStatus);
+    void _confirm_update(void);
+#endif
 };
 
 // --------------------------------------------------
@@ -0,0 +1,582 @@
+/*******************************************************************************
+* RoboCore Spool Library (v1.0)
+*
+* Library to store the uplinks that couldn't be sent in a persistent ring log,
+* so they are sent later in the same order.
+*
+* Copyright 2022 RoboCore.
+*
+*
+* This file is part of the SMW_SX1262M0 library ("SMW_SX1262M0-lib").
+*
+* "SMW_SX1262M0-lib" is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* "SMW_SX1262M0-lib" is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with "SMW_SX1262M0-lib". If not, see <https://www.gnu.org/licenses/>
+*******************************************************************************/
+
+// --------------------------------------------------
+// Libraries
+
+#include "Spool.h"
+
+// --------------------------------------------------
+// Dependencies
+
+extern "C" {
+  #include <string.h>
+}
+
+#ifdef SPOOL_EEPROM
+#include <Arduino.h>
+#include <EEPROM.h>
+#endif
+
+#ifdef SPOOL_FILE
+extern "C" {
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <unistd.h>
+}
+#endif
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+// Store a number in an array (little endian)
+//  @param (data) : the array [uint8_t *]
+//         (value) : the number [uint32_t]
+//         (size) : the number of bytes [uint8_t]
+static inline void store_le(uint8_t *data, uint32_t value, uint8_t size){
+  for(uint8_t i=0 ; i < size ; i++){
+    data[i] = value >> (8 * i);
+  }
+}
+
+// Load a number from an array (little endian)
+//  @param (data) : the array [uint8_t *]
+//         (size) : the number of bytes [uint8_t]
+//  @returns the number [uint32_t]
+static inline uint32_t load_le(const uint8_t *data, uint8_t size){
+  uint32_t value = 0;
+  for(uint8_t i=size ; i > 0 ; i--){
+    value = (value << 8) | data[i - 1];
+  }
+  return value;
+}
+
+// Get the checksum of a slot of the header
+//  @param (data) : the slot [uint8_t *]
+//  @returns the checksum of the fields (one's complement of the sum) [uint8_t]
+static inline uint8_t checksum(const uint8_t *data){
+  uint8_t sum = 0;
+  for(uint8_t i=0 ; i < (SPOOL_HEADER_SIZE - 2) ; i++){
+    sum += data[i];
+  }
+  return ~sum;
+}
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+// Commit the written data to the storage
+//  NOTE: the default storage writes the data immediately.
+void SpoolStorage::commit(void){
+  // do nothing
+}
+
+// --------------------------------------------------
+
+// Commit the written data to the storage now
+//  NOTE: the default storage doesn't delay the commits.
+void SpoolStorage::flush(void){
+  // do nothing
+}
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+#ifdef SPOOL_EEPROM
+
+// Constructor
+//  @param (address) : the first address of the EEPROM to use [uint16_t]
+//         (size) : the number of bytes to use [uint16_t] (0 for the rest of the EEPROM)
+//         (interval) : the minimum time between the commits [ms] (0 to commit every change)
+SpoolEEPROM::SpoolEEPROM(uint16_t address, uint16_t size, uint32_t interval) :
+  _address(address),
+  _size(size),
+  _interval(interval),
+  _commit_time(0),
+  _pending(false)
+  {
+}
+
+// --------------------------------------------------
+
+// Commit the written data to the flash
+//  NOTE: the data is committed only if the interval has passed since the
+//        last commit, otherwise it is kept pending.
+void SpoolEEPROM::commit(void){
+  if(_pending && ((millis() - _commit_time) >= _interval)){
+    flush();
+  }
+}
+
+// --------------------------------------------------
+
+// Commit the written data to the flash now
+void SpoolEEPROM::flush(void){
+  if(!_pending){
+    return;
+  }
+
+#ifdef ESP32
+  EEPROM.commit();
+#endif
+  _pending = false; // reset
+  _commit_time = millis();
+}
+
+// --------------------------------------------------
+
+// Read from the EEPROM
+//  @param (address) : the first address [uint32_t]
+//         (data) : the array to store the bytes [uint8_t *]
+//         (length) : the number of bytes [uint16_t]
+//  @returns false if out of the storage [bool]
+bool SpoolEEPROM::read(uint32_t address, uint8_t *data, uint16_t length){
+  if((address + length) > size()){
+    return false;
+  }
+  for(uint16_t i=0 ; i < length ; i++){
+    data[i] = EEPROM.read(_address + address + i);
+  }
+  return true;
+}
+
+// --------------------------------------------------
+
+// Get the size of the storage
+//  @returns the number of bytes [uint32_t]
+uint32_t SpoolEEPROM::size(void){
+  uint32_t length = EEPROM.length();
+  if(_address >= length){
+    return 0;
+  }
+  length -= _address;
+  return ((_size > 0) && (_size < length)) ? _size : length;
+}
+
+// --------------------------------------------------
+
+// Write to the EEPROM
+//  @param (address) : the first address [uint32_t]
+//         (data) : the bytes to write [uint8_t *]
+//         (length) : the number of bytes [uint16_t]
+//  @returns false if out of the storage [bool]
+//  NOTE: on AVR, only the changed bytes are written (wear of the cells).
+bool SpoolEEPROM::write(uint32_t address, const uint8_t *data, uint16_t length){
+  if((address + length) > size()){
+    return false;
+  }
+  for(uint16_t i=0 ; i < length ; i++){
+#ifdef __AVR__
+    EEPROM.update(_address + address + i, data[i]);
+#else
+    EEPROM.write(_address + address + i, data[i]);
+#endif
+  }
+  _pending = true; // set
+  return true;
+}
+
+#endif
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+#ifdef SPOOL_FILE
+
+// Constructor
+//  @param (path) : the path of the file [char *]
+//         (size) : the size of the file [bytes]
+//  NOTE: the path is not copied, so it must be valid while the file is open.
+SpoolFile::SpoolFile(const char *path, uint32_t size) :
+  _path(path),
+  _size(size),
+  _file(-1),
+  _data(nullptr)
+  {
+}
+
+// --------------------------------------------------
+
+// Destructor
+SpoolFile::~SpoolFile(void){
+  close();
+}
+
+// --------------------------------------------------
+
+// Close the file
+void SpoolFile::close(void){
+  if(_data != nullptr){
+    msync(_data, _size, MS_SYNC);
+    munmap(_data, _size);
+    _data = nullptr; // reset
+  }
+  if(_file >= 0){
+    ::close(_file);
+    _file = -1; // reset
+  }
+}
+
+// --------------------------------------------------
+
+// Commit the written data to the file
+void SpoolFile::commit(void){
+  if(_data != nullptr){
+    msync(_data, _size, MS_SYNC);
+  }
+}
+
+// --------------------------------------------------
+
+// Open (or create) the file and map it to the memory
+//  @returns true if the file is mapped [bool]
+bool SpoolFile::open(void){
+  close(); // reset
+
+  _file = ::open(_path, O_RDWR | O_CREAT, 0644);
+  if(_file < 0){
+    return false;
+  }
+  if(ftruncate(_file, _size) != 0){
+    close();
+    return false;
+  }
+
+  void *data = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _file, 0);
+  if(data == MAP_FAILED){
+    close();
+    return false;
+  }
+  _data = static_cast<uint8_t *>(data);
+  return true;
+}
+
+// --------------------------------------------------
+
+// Read from the file
+//  @param (address) : the first address [uint32_t]
+//         (data) : the array to store the bytes [uint8_t *]
+//         (length) : the number of bytes [uint16_t]
+//  @returns false if the file is closed or if out of the storage [bool]
+bool SpoolFile::read(uint32_t address, uint8_t *data, uint16_t length){
+  if((_data == nullptr) || ((address + length) > _size)){
+    return false;
+  }
+  memcpy(data, &_data[address], length);
+  return true;
+}
+
+// --------------------------------------------------
+
+// Get the size of the storage
+//  @returns the number of bytes, or 0 if the file is closed [uint32_t]
+uint32_t SpoolFile::size(void){
+  return (_data != nullptr) ? _size : 0;
+}
+
+// --------------------------------------------------
+
+// Write to the file
+//  @param (address) : the first address [uint32_t]
+//         (data) : the bytes to write [uint8_t *]
+//         (length) : the number of bytes [uint16_t]
+//  @returns false if the file is closed or if out of the storage [bool]
+bool SpoolFile::write(uint32_t address, const uint8_t *data, uint16_t length){
+  if((_data == nullptr) || ((address + length) > _size)){
+    return false;
+  }
+  memcpy(&_data[address], data, length);
+  return true;
+}
+
+#endif
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+// Constructor
+//  @param (storage) : the storage of the records [SpoolStorage]
+//         (policy) : what to do when a record doesn't fit [SpoolPolicy]
+//  NOTE: call <begin()> to load the records of the storage.
+Spool::Spool(SpoolStorage &storage, SpoolPolicy policy) :
+  _storage(&storage),
+  _policy(policy),
+  _capacity(0),
+  _head(0),
+  _tail(0),
+  _count(0),
+  _sequence(0),
+  _dropped(0)
+  {
+}
+
+// --------------------------------------------------
+
+// Load the records of the storage
+//  @returns false if the storage is too small [bool]
+//  NOTE: the spool is cleared if the storage has no valid header.
+bool Spool::begin(void){
+  uint32_t size = _storage->size();
+  if(size <= (2 * SPOOL_HEADER_SIZE + SPOOL_RECORD_OVERHEAD)){
+    _capacity = 0; // invalid
+    return false;
+  }
+  _capacity = size - (2 * SPOOL_HEADER_SIZE);
+
+  // load the newest valid slot of the header
+  bool valid0 = _load(0);
+  uint16_t sequence0 = _sequence;
+  if(_load(1)){
+    if(valid0 && (static_cast<int16_t>(sequence0 - _sequence) > 0)){
+      _load(0);
+    }
+  } else if(valid0){
+    _load(0);
+  } else {
+    clear(); // format
+  }
+  return true;
+}
+
+// --------------------------------------------------
+
+// Remove all the records
+void Spool::clear(void){
+  _head = 0;
+  _tail = 0;
+  _count = 0;
+  _save();
+}
+
+// --------------------------------------------------
+
+// Commit the pending changes of the storage
+//  NOTE: call periodically when the storage delays the commits (see
+//        <SpoolEEPROM>). Called by <SMW_SX1262M0::poll()>.
+void Spool::commit(void){
+  _storage->commit();
+}
+
+// --------------------------------------------------
+
+// Get the number of records
+//  @returns the number of records [uint16_t]
+uint16_t Spool::count(void){
+  return _count;
+}
+
+// --------------------------------------------------
+
+// Get the number of records dropped since <begin()>
+//  @returns the number of records [uint32_t]
+uint32_t Spool::dropped(void){
+  return _dropped;
+}
+
+// --------------------------------------------------
+
+// Commit the pending changes of the storage now
+//  NOTE: call before a planned reset or power off.
+void Spool::flush(void){
+  _storage->flush();
+}
+
+// --------------------------------------------------
+
+// Get the oldest record
+//  @param (port) : the variable to store the application port [uint8_t (&)]
+//         (data) : the array to store the payload [uint8_t *]
+//         (length) : the size of the array, replaced by the length of the payload [uint8_t (&)]
+//  @returns false if empty or if the array is too small [bool]
+bool Spool::peek(uint8_t (&port), uint8_t *data, uint8_t (&length)){
+  if(_count == 0){
+    return false;
+  }
+
+  uint8_t header[SPOOL_RECORD_OVERHEAD];
+  if(!_read(_head, header, sizeof(header)) || (header[1] > length)){
+    return false;
+  }
+  if(!_read((_head + SPOOL_RECORD_OVERHEAD) % _capacity, data, header[1])){
+    return false;
+  }
+  port = header[0];
+  length = header[1];
+  return true;
+}
+
+// --------------------------------------------------
+
+// Remove the oldest record
+//  @returns false if empty [bool]
+bool Spool::pop(void){
+  uint8_t header[SPOOL_RECORD_OVERHEAD];
+  if((_count == 0) || !_read(_head, header, sizeof(header))){
+    return false;
+  }
+
+  _head = (_head + SPOOL_RECORD_OVERHEAD + header[1]) % _capacity;
+  _count--;
+  if(_count == 0){
+    _head = 0; // reset (the next records start aligned)
+    _tail = 0; // reset
+  }
+  return _save();
+}
+
+// --------------------------------------------------
+
+// Add a record
+//  @param (port) : the application port [uint8_t]
+//         (data) : the payload [uint8_t *]
+//         (length) : the length of the payload [uint8_t]
+//  @returns false if the record was not stored [bool]
+//  NOTE: when the spool is full, the policy decides which record is dropped.
+bool Spool::push(uint8_t port, const uint8_t *data, uint8_t length){
+  uint32_t size = SPOOL_RECORD_OVERHEAD + length;
+  if((_capacity == 0) || (size > _capacity) || (length > SPOOL_RECORD_SIZE)){
+    return false;
+  }
+
+  // make room
+  while(_free() < size){
+    if(_policy == SpoolPolicy::DROP_NEWEST){
+      _dropped++;
+      return false;
+    }
+    if(!pop()){
+      return false; // the storage failed
+    }
+    _dropped++;
+  }
+
+  // write the record, then the header
+  uint8_t header[SPOOL_RECORD_OVERHEAD] = { port , length };
+  if(!_write(_tail, header, sizeof(header)) ||
+      !_write((_tail + SPOOL_RECORD_OVERHEAD) % _capacity, data, length)){
+    return false;
+  }
+  _tail = (_tail + size) % _capacity;
+  _count++;
+  return _save();
+}
+
+// --------------------------------------------------
+// --------------------------------------------------
+
+// Get the free space of the ring
+//  @returns the number of bytes [uint32_t]
+uint32_t Spool::_free(void){
+  if(_count == 0){
+    return _capacity;
+  }
+  return (_head + _capacity - _tail) % _capacity; // the tail reached the head when full
+}
+
+// --------------------------------------------------
+
+// Load a slot of the header
+//  @param (slot) : the index of the slot [uint8_t] (0-1)
+//  @returns true if the slot is valid [bool]
+bool Spool::_load(uint8_t slot){
+  uint8_t data[SPOOL_HEADER_SIZE];
+  if(!_storage->read(slot * SPOOL_HEADER_SIZE, data, sizeof(data))){
+    return false;
+  }
+
+  // check
+  if((load_le(&data[0], 2) != SPOOL_MAGIC) || (data[SPOOL_HEADER_SIZE - 2] != checksum(data))){
+    return false;
+  }
+  uint32_t head = load_le(&data[4], 4);
+  uint32_t tail = load_le(&data[8], 4);
+  if((head >= _capacity) || (tail >= _capacity)){
+    return false;
+  }
+
+  _sequence = load_le(&data[2], 2);
+  _head = head;
+  _tail = tail;
+  _count = load_le(&data[12], 2);
+  return true;
+}
+
+// --------------------------------------------------
+
+// Read from the ring
+//  @param (address) : the first address in the ring [uint32_t]
+//         (data) : the array to store the bytes [uint8_t *]
+//         (length) : the number of bytes [uint16_t]
+//  @returns false if the storage failed [bool]
+bool Spool::_read(uint32_t address, uint8_t *data, uint16_t length){
+  uint32_t first = _capacity - address; // bytes until the end of the ring
+  if(first >= length){
+    return _storage->read((2 * SPOOL_HEADER_SIZE) + address, data, length);
+  }
+  return _storage->read((2 * SPOOL_HEADER_SIZE) + address, data, first) &&
+    _storage->read(2 * SPOOL_HEADER_SIZE, &data[first], length - first);
+}
+
+// --------------------------------------------------
+
+// Save the header in the next slot
+//  @returns false if the storage failed [bool]
+bool Spool::_save(void){
+  if(_capacity == 0){
+    return false;
+  }
+
+  uint8_t data[SPOOL_HEADER_SIZE];
+  _sequence++;
+  store_le(&data[0], SPOOL_MAGIC, 2);
+  store_le(&data[2], _sequence, 2);
+  store_le(&data[4], _head, 4);
+  store_le(&data[8], _tail, 4);
+  store_le(&data[12], _count, 2);
+  data[SPOOL_HEADER_SIZE - 2] = checksum(data);
+  data[SPOOL_HEADER_SIZE - 1] = 0; // reserved
+
+  bool res = _storage->write((_sequence & 0x01) * SPOOL_HEADER_SIZE, data, sizeof(data));
+  _storage->commit();
+  return res;
+}
+
+// --------------------------------------------------
+
+// Write to the ring
+//  @param (address) : the first address in the ring [uint32_t]
+//         (data) : the bytes to write [uint8_t *]
+//         (length) : the number of bytes [uint16_t]
+//  @returns false if the storage failed [bool]
+bool Spool::_write(uint32_t address, const uint8_t *data, uint16_t length){
+  uint32_t first = _capacity - address; // bytes until the end of the ring
+  if(first >= length){
+    return _storage->write((2 * SPOOL_HEADER_SIZE) + address, data, length);
+  }
+  return _storage->write((2 * SPOOL_HEADER_SIZE) + address, data, first) &&
+    _storage->write(2 * SPOOL_HEADER_SIZE, &data[first], length - first);
+}
+
+// --------------------------------------------------
@@ -0,0 +1,173 @@
+#ifndef SPOOL_H
+#define SPOOL_H
+
+/*******************************************************************************
+* RoboCore Spool Library (v1.0)
+*
+* Library to store the uplinks that couldn't be sent in a persistent ring log,
+* so they are sent later in the same order.
+*
+* Copyright 2022 RoboCore.
+*
+*
+* This file is part of the SMW_SX1262M0 library ("SMW_SX1262M0-lib").
+*
+* "SMW_SX1262M0-lib" is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* "SMW_SX1262M0-lib" is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with "SMW_SX1262M0-lib". If not, see <https://www.gnu.org/licenses/>
+*******************************************************************************/
+
+// --------------------------------------------------
+// Dependencies
+
+extern "C" {
+  #include <stddef.h>
+  #include <stdint.h>
+}
+
+// --------------------------------------------------
+// Macros
+
+#define SPOOL_HEADER_SIZE    16 // [bytes] (one slot of the header, there are two)
+#define SPOOL_MAGIC      0x534C // (the signature of a valid header)
+#define SPOOL_RECORD_OVERHEAD 2 // [bytes] (port and length)
+#ifndef SPOOL_RECORD_SIZE
+#if defined(__AVR__)
+#define SPOOL_RECORD_SIZE    51 // [bytes] (limited by the RAM)
+#else
+#define SPOOL_RECORD_SIZE   242 // [bytes] (maximum payload of AU915)
+#endif
+#endif
+#ifndef SPOOL_COMMIT_INTERVAL
+#define SPOOL_COMMIT_INTERVAL 10000 // [ms] (minimum time between the commits of the EEPROM of the ESP32)
+#endif
+
+#if defined(__AVR__) || defined(ESP32)
+#define SPOOL_EEPROM
+#endif
+#if defined(__linux__)
+#define SPOOL_FILE
+#endif
+
+// --------------------------------------------------
+
+// What to do when a record doesn't fit the spool
+//  DROP_OLDEST : remove the oldest records to make room
+//  DROP_NEWEST : reject the new record
+enum class SpoolPolicy : uint8_t { DROP_OLDEST , DROP_NEWEST };
+
+// -----------------------------------------------------------------
+
+// The storage of a spool
+//  NOTE: the addresses are relative to the beginning of the storage.
+class SpoolStorage {
+  public:
+    virtual ~SpoolStorage() {}
+    virtual void commit(void);
+    virtual void flush(void);
+    virtual bool read(uint32_t, uint8_t *, uint16_t) = 0;
+    virtual uint32_t size(void) = 0;
+    virtual bool write(uint32_t, const uint8_t *, uint16_t) = 0;
+};
+
+// --------------------------------------------------
+
+#ifdef SPOOL_EEPROM
+
+// The storage in the EEPROM (emulated in the flash of the ESP32)
+//  NOTE: on the ESP32, call <EEPROM.begin()> before using the spool. Each
+//        commit erases and writes a sector of the flash, so the changes are
+//        committed at most once per interval (see <Spool::commit()>) and the
+//        changes of the last interval are lost on a power loss.
+class SpoolEEPROM : public SpoolStorage {
+  public:
+    SpoolEEPROM(uint16_t = 0, uint16_t = 0, uint32_t = SPOOL_COMMIT_INTERVAL);
+    void commit(void);
+    void flush(void);
+    bool read(uint32_t, uint8_t *, uint16_t);
+    uint32_t size(void);
+    bool write(uint32_t, const uint8_t *, uint16_t);
+
+  private:
+    uint16_t _address;
+    uint16_t _size;
+    uint32_t _interval;
+    uint32_t _commit_time;
+    bool _pending;
+};
+
+#endif
+
+// --------------------------------------------------
+
+#ifdef SPOOL_FILE
+
+// The storage in a memory-mapped file (Linux)
+//  NOTE: the file is created (or resized) when opened.
+class SpoolFile : public SpoolStorage {
+  public:
+    SpoolFile(const char *, uint32_t);
+    ~SpoolFile(void);
+    void close(void);
+    void commit(void);
+    bool open(void);
+    bool read(uint32_t, uint8_t *, uint16_t);
+    uint32_t size(void);
+    bool write(uint32_t, const uint8_t *, uint16_t);
+
+  private:
+    const char *_path;
+    uint32_t _size;
+    int _file;
+    uint8_t *_data;
+};
+
+#endif
+
+// -----------------------------------------------------------------
+
+// The ring log of the records
+//  NOTE: the header is written after the data and alternates between two
+//        slots, so a power loss keeps the last consistent state.
+class Spool {
+  public:
+    Spool(SpoolStorage (&), SpoolPolicy = SpoolPolicy::DROP_OLDEST);
+    bool begin(void);
+    void clear(void);
+    void commit(void);
+    uint16_t count(void);
+    uint32_t dropped(void);
+    void flush(void);
+    bool peek(uint8_t (&), uint8_t *, uint8_t (&));
+    bool pop(void);
+    bool push(uint8_t, const uint8_t *, uint8_t);
+
+  private:
+    SpoolStorage *_storage;
+    SpoolPolicy _policy;
+    uint32_t _capacity;
+    uint32_t _head;
+    uint32_t _tail;
+    uint16_t _count;
+    uint16_t _sequence;
+    uint32_t _dropped;
+
+    uint32_t _free(void);
+    bool _load(uint8_t);
+    bool _read(uint32_t, uint8_t *, uint16_t);
+    bool _save(void);
+    bool _write(uint32_t, const uint8_t *, uint16_t);
+};
+
+// -----------------------------------------------------------------
+
+#endif // SPOOL_H